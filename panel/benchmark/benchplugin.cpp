@@ -0,0 +1,72 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "benchplugin.h"
+#include <QHBoxLayout>
+
+
+/************************************************
+
+ ************************************************/
+BenchPlugin::BenchPlugin(const ILxQtPanelPluginStartupInfo &startupInfo):
+    ILxQtPanelPlugin(startupInfo)
+{
+    int buttons = settings()->value("buttons", 0).toInt();
+    if (buttons <= 0)
+    {
+        mWidget = createButton("Bench");
+        return;
+    }
+
+    mWidget = new QWidget();
+    QHBoxLayout *layout = new QHBoxLayout(mWidget);
+    layout->setMargin(0);
+    layout->setSpacing(0);
+    for (int i = 0; i < buttons; ++i)
+        layout->addWidget(createButton(QString::number(i), mWidget));
+}
+
+
+/************************************************
+
+ ************************************************/
+BenchPlugin::~BenchPlugin()
+{
+    delete mWidget;
+}
+
+
+/************************************************
+
+ ************************************************/
+QToolButton *BenchPlugin::createButton(const QString &text, QWidget *parent)
+{
+    QToolButton *button = new QToolButton(parent);
+    button->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
+    button->setIcon(QIcon::fromTheme("application-x-executable"));
+    button->setAutoRaise(true);
+    button->setText(text);
+    return button;
+}
@@ -0,0 +1,65 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef BENCHPLUGIN_H
+#define BENCHPLUGIN_H
+
+#include "../ilxqtpanelplugin.h"
+#include <QToolButton>
+
+/*! Synthetic plugin for the benchmark tools. It's a plain text
+    button, the benchmark changes its text to make it resize.
+    With the "buttons" setting the plugin shows a row of buttons,
+    like the taskbar.
+ */
+class BenchPlugin: public ILxQtPanelPlugin
+{
+public:
+    BenchPlugin(const ILxQtPanelPluginStartupInfo &startupInfo);
+    ~BenchPlugin();
+
+    virtual QWidget *widget() { return mWidget; }
+    virtual QString themeId() const { return "Bench"; }
+
+private:
+    QWidget *mWidget;
+
+    QToolButton *createButton(const QString &text, QWidget *parent = 0);
+};
+
+
+class BenchPluginLibrary: public QObject, public ILxQtPanelPluginLibrary
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "lxde-qt.org/Panel/PluginInterface/3.1")
+    Q_INTERFACES(ILxQtPanelPluginLibrary)
+public:
+    ILxQtPanelPlugin *instance(const ILxQtPanelPluginStartupInfo &startupInfo)
+    {
+        return new BenchPlugin(startupInfo);
+    }
+};
+
+#endif // BENCHPLUGIN_H
@@ -0,0 +1,543 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "../lxqtpanelapplication.h"
+#include "../lxqtpanel.h"
+#include "../lxqtpanellayout.h"
+#include "../plugin.h"
+#include <QColor>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QToolButton>
+#include <QVector>
+#include <QtAlgorithms>
+#include <csignal>
+#include <sys/types.h>
+
+/*! The lxqt-panel-bench starts the panel on a private Xvfb display with a
+    generated config and the synthetic "benchplugin" plugins, and prints
+    the results as JSON:
+      - startup:  the time from the creation of the application to the first
+                  paint of the panel;
+      - realign:  the time from a change of the panel size, position or line
+                  count to the end of the realign;
+      - relayout: the cost of the panel layout with 1, 10 and 50 plugins;
+      - opacity:  the time to change the opacity of a panel with 200 buttons
+                  and repaint it.
+
+  Usage: lxqt-panel-bench [options]
+ */
+
+#define STARTUP_PLUGINS   10
+#define WAIT_TIMEOUT      10000
+
+#define OPACITY_BUTTONS   200
+
+static const int RELAYOUT_PLUGINS[] = { 1, 10, 50 };
+
+
+/************************************************
+ Catches the first paint of the watched widget.
+ ************************************************/
+class PaintWatcher: public QObject
+{
+public:
+    PaintWatcher(QWidget *widget):
+        QObject(),
+        mPainted(false)
+    {
+        widget->installEventFilter(this);
+    }
+
+    bool isPainted() const { return mPainted; }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event)
+    {
+        if (event->type() == QEvent::Paint)
+            mPainted = true;
+
+        return QObject::eventFilter(watched, event);
+    }
+
+private:
+    bool mPainted;
+};
+
+
+/************************************************
+
+ ************************************************/
+void printHelp()
+{
+    QTextStream out(stdout);
+    out << "Usage: lxqt-panel-bench [options]" << endl;
+    out << endl;
+    out << "Measure the startup, realign and relayout time of lxqt-panel" << endl;
+    out << endl;
+    out << "Options:" << endl;
+    out << "  -h, --help                    Show help about options" << endl;
+    out << "      --display=DISPLAY         Use the running X server instead of Xvfb" << endl;
+    out << "      --xvfb-display=DISPLAY    Start Xvfb on DISPLAY (default :99)" << endl;
+    out << "  -n, --iterations=COUNT        Repeat each measurement COUNT times (default 20)" << endl;
+    out << "  -o, --output=FILE             Write the results to FILE instead of stdout" << endl;
+}
+
+
+/************************************************
+
+ ************************************************/
+static QString optionValue(const QString &arg, int *i, int argc, char *argv[])
+{
+    int n = arg.indexOf('=');
+    if (n > -1)
+        return arg.mid(n + 1);
+
+    if (*i + 1 < argc)
+    {
+        ++(*i);
+        return QString::fromLocal8Bit(argv[*i]);
+    }
+
+    return QString();
+}
+
+
+/************************************************
+
+ ************************************************/
+static bool startXvfb(const QString &display, qint64 *pid)
+{
+    QStringList args;
+    args << display << "-screen" << "0" << "1920x1080x24" << "-nolisten" << "tcp";
+    if (!QProcess::startDetached("Xvfb", args, QDir::rootPath(), pid))
+    {
+        qWarning() << "Can't start Xvfb";
+        return false;
+    }
+
+    // Xvfb is ready when it creates the socket.
+    QString num = display.mid(1).section('.', 0, 0);
+    QString socket = QString("/tmp/.X11-unix/X%1").arg(num);
+    for (int i = 0; i < WAIT_TIMEOUT / 50; ++i)
+    {
+        if (QFileInfo(socket).exists())
+            return true;
+
+        QThread::msleep(50);
+    }
+
+    qWarning() << "Xvfb doesn't listen on" << socket;
+    kill(*pid, SIGTERM);
+    return false;
+}
+
+
+/************************************************
+
+ ************************************************/
+static void writePanel(QSettings &conf, const QString &panel, int pluginCount)
+{
+    QStringList plugins;
+    for (int i = 0; i < pluginCount; ++i)
+    {
+        QString group = QString("%1-bench%2").arg(panel).arg(i);
+        conf.setValue(group + "/type", "benchplugin");
+        conf.setValue(group + "/alignment", "Left");
+        plugins << group;
+    }
+
+    conf.beginGroup(panel);
+    conf.setValue("plugins", plugins);
+    conf.setValue("position", "Bottom");
+    conf.setValue("panelSize", 32);
+    conf.setValue("iconSize", 22);
+    conf.setValue("lineCount", 1);
+    conf.setValue("desktop", 0);
+    conf.endGroup();
+}
+
+
+/************************************************
+ The panel uses only the files from the temporary
+ directory, the user config isn't touched.
+ ************************************************/
+static QString prepareEnvironment(const QString &dir)
+{
+    QDir(dir).mkpath("config");
+    QDir(dir).mkpath("cache");
+    QDir(dir).mkpath("data");
+    QDir(dir).mkpath("desktop");
+
+    qputenv("XDG_CONFIG_HOME", QFile::encodeName(dir + "/config"));
+    qputenv("XDG_CACHE_HOME", QFile::encodeName(dir + "/cache"));
+    qputenv("XDG_DATA_HOME", QFile::encodeName(dir + "/data"));
+    qputenv("LXQT_PANEL_PLUGINS_DIR", QFile::encodeName(dir + "/desktop"));
+    qputenv("LXQTPANEL_PLUGIN_PATH", BENCH_PLUGIN_DIR);
+
+    QFile desktop(dir + "/desktop/benchplugin.desktop");
+    if (desktop.open(QFile::WriteOnly))
+    {
+        QTextStream out(&desktop);
+        out << "[Desktop Entry]" << endl;
+        out << "Type=Service" << endl;
+        out << "ServiceTypes=LxQtPanel/Plugin" << endl;
+        out << "Name=Benchmark" << endl;
+        out << "Comment=Synthetic plugin for lxqt-panel-bench" << endl;
+    }
+
+    QString configFile = dir + "/panel.conf";
+    QSettings conf(configFile, QSettings::IniFormat);
+    conf.setValue("panels", QStringList() << "startup");
+    writePanel(conf, "startup", STARTUP_PLUGINS);
+    for (uint i = 0; i < sizeof(RELAYOUT_PLUGINS) / sizeof(int); ++i)
+        writePanel(conf, QString("relayout%1").arg(RELAYOUT_PLUGINS[i]), RELAYOUT_PLUGINS[i]);
+
+    writePanel(conf, "opacity", 1);
+    conf.setValue("opacity/background-color", QColor(Qt::darkGray));
+    conf.setValue("opacity-bench0/buttons", OPACITY_BUTTONS);
+
+    conf.sync();
+    return configFile;
+}
+
+
+/************************************************
+
+ ************************************************/
+static void waitForPaint(const PaintWatcher &watcher)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!watcher.isPainted() && timer.elapsed() < WAIT_TIMEOUT)
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+}
+
+
+/************************************************
+ Lets the panel process all the events left after
+ the previous measurement.
+ ************************************************/
+static void settle()
+{
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+}
+
+
+/************************************************
+
+ ************************************************/
+static QJsonObject summary(QVector<qint64> samples)
+{
+    QJsonObject res;
+    if (samples.isEmpty())
+        return res;
+
+    qSort(samples);
+    qint64 sum = 0;
+    foreach (qint64 sample, samples)
+        sum += sample;
+
+    res["iterations"] = samples.count();
+    res["min_us"]     = samples.first() / 1000.0;
+    res["median_us"]  = samples.at(samples.count() / 2) / 1000.0;
+    res["mean_us"]    = sum / samples.count() / 1000.0;
+    res["max_us"]     = samples.last() / 1000.0;
+    return res;
+}
+
+
+/************************************************
+
+ ************************************************/
+enum RealignChange
+{
+    ChangePanelSize,
+    ChangePosition,
+    ChangeLineCount
+};
+
+static void applyChange(LxQtPanel *panel, RealignChange change, int i)
+{
+    switch (change)
+    {
+    case ChangePanelSize:
+        panel->setPanelSize(i % 2 ? 48 : 32, false);
+        break;
+
+    case ChangePosition:
+        panel->setPosition(panel->screenNum(), i % 2 ? ILxQtPanel::PositionTop : ILxQtPanel::PositionBottom, false);
+        break;
+
+    case ChangeLineCount:
+        panel->setLineCount(i % 2 ? 2 : 1, false);
+        break;
+    }
+}
+
+
+/************************************************
+ The panel merges the changes, so we wait until the
+ scheduled realign is really done.
+ ************************************************/
+static QJsonObject measureRealign(LxQtPanel *panel, RealignChange change, int iterations)
+{
+    QVector<qint64> samples;
+    QElapsedTimer timer;
+    for (int i = 1; i <= iterations * 2; ++i)
+    {
+        settle();
+        int count = panel->realignCount();
+        timer.start();
+        applyChange(panel, change, i);
+        while (panel->realignCount() == count && timer.elapsed() < WAIT_TIMEOUT)
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+
+        samples << timer.nsecsElapsed();
+    }
+
+    return summary(samples);
+}
+
+
+/************************************************
+
+ ************************************************/
+static QJsonObject measureRelayout(const QString &name, int iterations)
+{
+    QJsonObject res;
+
+    LxQtPanel *panel = new LxQtPanel(name);
+    PaintWatcher watcher(panel);
+    waitForPaint(watcher);
+    settle();
+
+    LxQtPanelLayout *layout = panel->findChild<LxQtPanelLayout*>();
+    QList<Plugin*> plugins = panel->findChildren<Plugin*>();
+    if (!layout || plugins.isEmpty())
+    {
+        qWarning() << "The panel" << name << "has no plugins";
+        delete panel;
+        return res;
+    }
+
+    // All the size hints are recalculated.
+    QVector<qint64> samples;
+    QElapsedTimer timer;
+    for (int i = 0; i < iterations; ++i)
+    {
+        timer.start();
+        layout->rebuild();
+        layout->activate();
+        samples << timer.nsecsElapsed();
+    }
+    res["full"] = summary(samples);
+    settle();
+
+    // One plugin in the middle is resized, like the clock when the text is changed.
+    QToolButton *button = qobject_cast<QToolButton*>(plugins.at(plugins.count() / 2)->widget());
+    if (!button)
+    {
+        delete panel;
+        return res;
+    }
+
+    int sizeHints = layout->sizeHintCount();
+    int geometries = layout->geometryCount();
+    samples.clear();
+    for (int i = 0; i < iterations; ++i)
+    {
+        timer.start();
+        button->setText(i % 2 ? "Bench" : "Benchmark");
+        QCoreApplication::sendPostedEvents(0, QEvent::LayoutRequest);
+        samples << timer.nsecsElapsed();
+        settle();
+    }
+    res["one_plugin"] = summary(samples);
+    res["size_hints_per_change"] = double(layout->sizeHintCount() - sizeHints) / iterations;
+    res["geometries_per_change"] = double(layout->geometryCount() - geometries) / iterations;
+
+    delete panel;
+    settle();
+    return res;
+}
+
+
+/************************************************
+ The change is done when the panel is repainted with
+ the new background.
+ ************************************************/
+static QJsonObject measureOpacity(int iterations)
+{
+    QJsonObject res;
+
+    LxQtPanel *panel = new LxQtPanel("opacity");
+    PaintWatcher watcher(panel);
+    waitForPaint(watcher);
+    settle();
+
+    QVector<qint64> samples;
+    QElapsedTimer timer;
+    for (int i = 0; i < iterations; ++i)
+    {
+        timer.start();
+        panel->setOpacity(i % 2 ? 50 : 100, false);
+        QCoreApplication::sendPostedEvents();
+        panel->repaint();
+        samples << timer.nsecsElapsed();
+        settle();
+    }
+
+    res["buttons"] = OPACITY_BUTTONS;
+    res["change"] = summary(samples);
+
+    delete panel;
+    settle();
+    return res;
+}
+
+
+/************************************************
+
+ ************************************************/
+int main(int argc, char *argv[])
+{
+    QString display;
+    QString xvfbDisplay = ":99";
+    QString outFile;
+    int iterations = 20;
+
+    for (int i=1; i < argc; ++i)
+    {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+
+        if (arg == "--help" || arg == "-h")
+        {
+            printHelp();
+            return 0;
+        }
+
+        if (arg.startsWith("--display"))
+            display = optionValue(arg, &i, argc, argv);
+        else if (arg.startsWith("--xvfb-display"))
+            xvfbDisplay = optionValue(arg, &i, argc, argv);
+        else if (arg == "-n" || arg.startsWith("--iterations"))
+            iterations = qMax(1, optionValue(arg, &i, argc, argv).toInt());
+        else if (arg == "-o" || arg.startsWith("--output"))
+            outFile = optionValue(arg, &i, argc, argv);
+    }
+
+    qint64 xvfbPid = 0;
+    if (display.isEmpty())
+    {
+        display = xvfbDisplay;
+        if (!startXvfb(display, &xvfbPid))
+            return 1;
+    }
+    qputenv("DISPLAY", display.toLocal8Bit());
+
+    QTemporaryDir tmpDir;
+    QString configFile = prepareEnvironment(tmpDir.path());
+
+    QJsonObject results;
+
+    // Startup ...................................
+    QElapsedTimer timer;
+    timer.start();
+    LxQtPanelApplication *app = new LxQtPanelApplication(argc, argv, configFile);
+
+    // The panel can't be painted before the event loop is started.
+    QTimer ticker;
+    ticker.start(10);
+
+    LxQtPanel *panel = app->panels().isEmpty() ? 0 : app->panels().first();
+    if (panel)
+    {
+        PaintWatcher watcher(panel);
+        waitForPaint(watcher);
+
+        QJsonObject startup;
+        startup["plugins"] = STARTUP_PLUGINS;
+        startup["first_paint_ms"] = timer.nsecsElapsed() / 1000000.0;
+        results["startup"] = startup;
+
+        // Realign ...................................
+        QJsonObject realign;
+        realign["panel_size"] = measureRealign(panel, ChangePanelSize, iterations);
+        realign["position"] = measureRealign(panel, ChangePosition, iterations);
+        realign["line_count"] = measureRealign(panel, ChangeLineCount, iterations);
+        results["realign"] = realign;
+    }
+    else
+    {
+        qWarning() << "The panel isn't created";
+    }
+
+    // Relayout ..................................
+    QJsonObject relayout;
+    for (uint i = 0; i < sizeof(RELAYOUT_PLUGINS) / sizeof(int); ++i)
+    {
+        int count = RELAYOUT_PLUGINS[i];
+        relayout[QString::number(count)] = measureRelayout(QString("relayout%1").arg(count), iterations);
+    }
+    results["relayout"] = relayout;
+
+    // Opacity ...................................
+    results["opacity"] = measureOpacity(iterations);
+
+    // Results ...................................
+    QByteArray json = QJsonDocument(results).toJson();
+    if (outFile.isEmpty())
+    {
+        QTextStream(stdout) << json;
+    }
+    else
+    {
+        QFile file(outFile);
+        if (file.open(QFile::WriteOnly))
+            file.write(json);
+        else
+            qWarning() << "Can't write" << outFile;
+    }
+
+    delete app;
+    if (xvfbPid)
+        kill(xvfbPid, SIGTERM);
+
+    return panel ? 0 : 1;
+}
@@ -0,0 +1,582 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "../ilxqtpanel.h"
+#include "../ilxqtpanelplugin.h"
+#include "../plugindescriptorindex.h"
+#include "../pluginlibraryloader.h"
+#include "../tickservice.h"
+#include "../windowpropertystore.h"
+#include "../windowiconcache.h"
+#include <QApplication>
+#include <QDebug>
+#include <QDesktopWidget>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFile>
+#include <QHBoxLayout>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPluginLoader>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimerEvent>
+#include <QWidget>
+#include <sys/resource.h>
+
+/*! The lxqt-panel-pluginhost loads one panel plugin without the panel and
+    measures what the plugin costs on its own. The plugin gets a fake panel
+    and a settings file in a temporary directory.
+
+  Usage: lxqt-panel-pluginhost [options] PLUGIN_ID
+
+  The script file changes the fake panel while the plugin is running, each
+  line is "<seconds> <key> <value>", the keys are position (Top, Bottom, Left,
+  Right), iconSize and lineCount. For example:
+      10 position Left
+      20 iconSize 32
+ */
+
+
+/************************************************
+
+ ************************************************/
+static ILxQtPanel::Position positionFromString(const QString &str)
+{
+    QString s = str.toLower();
+    if (s == "top")   return ILxQtPanel::PositionTop;
+    if (s == "left")  return ILxQtPanel::PositionLeft;
+    if (s == "right") return ILxQtPanel::PositionRight;
+    return ILxQtPanel::PositionBottom;
+}
+
+
+/************************************************
+
+ ************************************************/
+class FakePanel: public ILxQtPanel
+{
+public:
+    FakePanel():
+        mPosition(PositionBottom),
+        mIconSize(22),
+        mLineCount(1),
+        mWidget(0)
+    {
+    }
+
+    Position position() const { return mPosition; }
+    int iconSize() const { return mIconSize; }
+    int lineCount() const { return mLineCount; }
+
+    QRect globalGometry() const
+    {
+        return mWidget ? mWidget->geometry() : QRect();
+    }
+
+    QRect calculatePopupWindowPos(const ILxQtPanelPlugin *, const QSize &windowSize) const
+    {
+        QRect rect(QPoint(0, 0), windowSize);
+        QRect geometry = globalGometry();
+        switch (mPosition)
+        {
+        case PositionTop:    rect.moveTopLeft(geometry.bottomLeft());   break;
+        case PositionBottom: rect.moveBottomLeft(geometry.topLeft());   break;
+        case PositionLeft:   rect.moveTopLeft(geometry.topRight());     break;
+        case PositionRight:  rect.moveTopRight(geometry.topLeft());     break;
+        }
+        return rect;
+    }
+
+    // The plugin shares the timer like in the panel, so the wakeups are the same.
+    void subscribeTick(int interval, QObject *receiver, const char *member)
+    {
+        TickService::instance()->subscribe(mWidget, interval, receiver, member);
+    }
+
+    void unsubscribeTick(QObject *receiver)
+    {
+        TickService::instance()->unsubscribe(mWidget, receiver);
+    }
+
+    WindowProperties windowProperties(WId window) const
+    {
+        return WindowPropertyStore::instance()->properties(window);
+    }
+
+    QPixmap windowIcon(WId window, int size) const
+    {
+        return WindowIconCache::instance()->icon(window, size);
+    }
+
+    void setPosition(Position value) { mPosition = value; }
+    void setIconSize(int value) { mIconSize = value; }
+    void setLineCount(int value) { mLineCount = value; }
+    void setWidget(QWidget *widget) { mWidget = widget; }
+
+private:
+    Position mPosition;
+    int mIconSize;
+    int mLineCount;
+    QWidget *mWidget;
+};
+
+
+/************************************************
+ The window the plugin lives in, it's placed on the
+ screen edge like the panel.
+ ************************************************/
+class HostWindow: public QWidget
+{
+public:
+    HostWindow(FakePanel *panel):
+        QWidget(0, Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint),
+        mPanel(panel),
+        mPlugin(0)
+    {
+        QHBoxLayout *layout = new QHBoxLayout(this);
+        layout->setMargin(0);
+        layout->setSpacing(0);
+        mPanel->setWidget(this);
+    }
+
+    void setPlugin(ILxQtPanelPlugin *plugin)
+    {
+        mPlugin = plugin;
+        if (plugin->widget())
+            layout()->addWidget(plugin->widget());
+        realign();
+    }
+
+    void realign()
+    {
+        QRect screen = QApplication::desktop()->screenGeometry();
+        int size = mPanel->iconSize() * mPanel->lineCount() + 10;
+        QBoxLayout *box = static_cast<QBoxLayout*>(layout());
+        QRect rect;
+        switch (mPanel->position())
+        {
+        case ILxQtPanel::PositionTop:
+            box->setDirection(QBoxLayout::LeftToRight);
+            rect = QRect(screen.left(), screen.top(), screen.width(), size);
+            break;
+        case ILxQtPanel::PositionBottom:
+            box->setDirection(QBoxLayout::LeftToRight);
+            rect = QRect(screen.left(), screen.bottom() - size + 1, screen.width(), size);
+            break;
+        case ILxQtPanel::PositionLeft:
+            box->setDirection(QBoxLayout::TopToBottom);
+            rect = QRect(screen.left(), screen.top(), size, screen.height());
+            break;
+        case ILxQtPanel::PositionRight:
+            box->setDirection(QBoxLayout::TopToBottom);
+            rect = QRect(screen.right() - size + 1, screen.top(), size, screen.height());
+            break;
+        }
+
+        setGeometry(rect);
+        if (mPlugin)
+            mPlugin->realign();
+    }
+
+private:
+    FakePanel *mPanel;
+    ILxQtPanelPlugin *mPlugin;
+};
+
+
+/************************************************
+ Counts the wakeups and paints of the plugin. All the
+ objects of the host process except the host itself
+ belong to the plugin.
+ ************************************************/
+class EventCounter: public QObject
+{
+public:
+    EventCounter():
+        QObject(),
+        mTimers(0),
+        mSockets(0),
+        mPaints(0)
+    {
+        qApp->installEventFilter(this);
+    }
+
+    void ignore(QObject *object) { mIgnored << object; }
+    void reset() { mTimers = 0; mSockets = 0; mPaints = 0; }
+
+    int timers() const { return mTimers; }
+    int sockets() const { return mSockets; }
+    int paints() const { return mPaints; }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event)
+    {
+        switch (event->type())
+        {
+        case QEvent::Timer:
+            if (!mIgnored.contains(watched))
+                mTimers++;
+            break;
+
+        case QEvent::SockAct:
+            mSockets++;
+            break;
+
+        case QEvent::Paint:
+            mPaints++;
+            break;
+
+        default:
+            break;
+        }
+
+        return QObject::eventFilter(watched, event);
+    }
+
+private:
+    QList<QObject*> mIgnored;
+    int mTimers;
+    int mSockets;
+    int mPaints;
+};
+
+
+/************************************************
+ Runs the script and stops the application after
+ the measurement time.
+ ************************************************/
+class ScriptRunner: public QObject
+{
+public:
+    struct Step
+    {
+        int time;
+        QString key;
+        QString value;
+    };
+
+    ScriptRunner(FakePanel *panel, HostWindow *window):
+        QObject(),
+        mPanel(panel),
+        mWindow(window),
+        mFinishTimer(0)
+    {
+    }
+
+    bool load(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QFile::ReadOnly | QFile::Text))
+        {
+            qWarning() << "Can't read" << fileName;
+            return false;
+        }
+
+        QTextStream in(&file);
+        while (!in.atEnd())
+        {
+            QStringList line = in.readLine().simplified().split(' ', QString::SkipEmptyParts);
+            if (line.count() < 3 || line.first().startsWith('#'))
+                continue;
+
+            Step step;
+            step.time = line.at(0).toDouble() * 1000;
+            step.key = line.at(1);
+            step.value = line.at(2);
+            mSteps.insert(startTimer(step.time), step);
+        }
+
+        return true;
+    }
+
+    void finishAfter(int msec)
+    {
+        mFinishTimer = startTimer(msec);
+    }
+
+protected:
+    void timerEvent(QTimerEvent *event)
+    {
+        killTimer(event->timerId());
+        if (event->timerId() == mFinishTimer)
+        {
+            qApp->quit();
+            return;
+        }
+
+        Step step = mSteps.take(event->timerId());
+        if (step.key == "position")
+            mPanel->setPosition(positionFromString(step.value));
+        else if (step.key == "iconSize")
+            mPanel->setIconSize(step.value.toInt());
+        else if (step.key == "lineCount")
+            mPanel->setLineCount(step.value.toInt());
+        else
+            qWarning() << "Unknown script key" << step.key;
+
+        mWindow->realign();
+    }
+
+private:
+    FakePanel *mPanel;
+    HostWindow *mWindow;
+    QHash<int, Step> mSteps;
+    int mFinishTimer;
+
+};
+
+
+/************************************************
+
+ ************************************************/
+static qint64 cpuTime()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+            usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+
+/************************************************
+
+ ************************************************/
+static qint64 residentMemory()
+{
+    QFile file("/proc/self/status");
+    if (!file.open(QFile::ReadOnly | QFile::Text))
+        return 0;
+
+    QTextStream in(&file);
+    QString line;
+    while (!(line = in.readLine()).isNull())
+    {
+        if (line.startsWith("VmRSS:"))
+            return line.section(' ', 1, 1, QString::SectionSkipEmpty).toLongLong();
+    }
+
+    return 0;
+}
+
+
+/************************************************
+
+ ************************************************/
+void printHelp()
+{
+    QTextStream out(stdout);
+    out << "Usage: lxqt-panel-pluginhost [options] PLUGIN_ID" << endl;
+    out << endl;
+    out << "Load one lxqt-panel plugin without the panel and measure it" << endl;
+    out << endl;
+    out << "Options:" << endl;
+    out << "  -h, --help                    Show help about options" << endl;
+    out << "  -d, --duration=SECONDS        Measure for SECONDS (default 60)" << endl;
+    out << "      --position=POSITION       Top, Bottom (default), Left or Right" << endl;
+    out << "      --icon-size=SIZE          Icon size (default 22)" << endl;
+    out << "      --line-count=COUNT        Line count (default 1)" << endl;
+    out << "  -s, --script=FILE             Change the panel while measuring" << endl;
+    out << "  -o, --output=FILE             Write the results to FILE instead of stdout" << endl;
+}
+
+
+/************************************************
+
+ ************************************************/
+static QString optionValue(const QString &arg, int *i, int argc, char *argv[])
+{
+    int n = arg.indexOf('=');
+    if (n > -1)
+        return arg.mid(n + 1);
+
+    if (*i + 1 < argc)
+    {
+        ++(*i);
+        return QString::fromLocal8Bit(argv[*i]);
+    }
+
+    return QString();
+}
+
+
+/************************************************
+
+ ************************************************/
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    QString pluginId;
+    QString scriptFile;
+    QString outFile;
+    QString position;
+    int duration = 60;
+    FakePanel panel;
+
+    for (int i=1; i < argc; ++i)
+    {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+
+        if (arg == "--help" || arg == "-h")
+        {
+            printHelp();
+            return 0;
+        }
+
+        if (arg == "-d" || arg.startsWith("--duration"))
+            duration = qMax(1, optionValue(arg, &i, argc, argv).toInt());
+        else if (arg.startsWith("--position"))
+            position = optionValue(arg, &i, argc, argv);
+        else if (arg.startsWith("--icon-size"))
+            panel.setIconSize(optionValue(arg, &i, argc, argv).toInt());
+        else if (arg.startsWith("--line-count"))
+            panel.setLineCount(optionValue(arg, &i, argc, argv).toInt());
+        else if (arg == "-s" || arg.startsWith("--script"))
+            scriptFile = optionValue(arg, &i, argc, argv);
+        else if (arg == "-o" || arg.startsWith("--output"))
+            outFile = optionValue(arg, &i, argc, argv);
+        else if (!arg.startsWith('-'))
+            pluginId = arg;
+    }
+
+    if (pluginId.isEmpty())
+    {
+        printHelp();
+        return 1;
+    }
+
+    HostWindow window(&panel);
+    ScriptRunner script(&panel, &window);
+    if (!position.isEmpty())
+        panel.setPosition(positionFromString(position));
+
+    qint64 rssBefore = residentMemory();
+
+    // Load the plugin ...........................
+    LxQt::PluginInfo desktopFile = PluginDescriptorIndex::instance()->find(pluginId);
+    if (!desktopFile.isValid())
+        qWarning() << "No desktop file for" << pluginId;
+
+    PluginLibraryLoader::Result lib = PluginLibraryLoader::instance()->take(pluginId);
+    if (!lib.loader)
+    {
+        qWarning() << "Can't load" << pluginId << lib.error;
+        return 1;
+    }
+
+    ILxQtPanelPluginLibrary *pluginLib = qobject_cast<ILxQtPanelPluginLibrary*>(lib.loader->instance());
+    if (!pluginLib)
+    {
+        qWarning() << "Can't load" << pluginId << lib.loader->errorString();
+        delete lib.loader;
+        return 1;
+    }
+
+    // The settings live only as long as the host. They are written to a real
+    // INI file like the panel config, so the plugin gets its values back the
+    // same way as in the panel, e.g. QSize and QColor as @Variant strings.
+    // A format from QSettings::registerFormat() would still create its file.
+    QTemporaryDir settingsDir;
+    QSettings settings(settingsDir.path() + "/plugin.conf", QSettings::IniFormat);
+
+    ILxQtPanelPluginStartupInfo startupInfo;
+    startupInfo.settings = &settings;
+    startupInfo.lxqtPanel = &panel;
+    startupInfo.desktopFile = &desktopFile;
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 cpuStart = cpuTime();
+    ILxQtPanelPlugin *plugin = pluginLib->instance(startupInfo);
+    if (!plugin)
+    {
+        qWarning() << "Can't create" << pluginId;
+        delete lib.loader;
+        return 1;
+    }
+
+    window.setPlugin(plugin);
+    window.show();
+    qint64 createTime = timer.nsecsElapsed();
+    qint64 createCpu = cpuTime() - cpuStart;
+
+    // Measure ...................................
+    EventCounter counter;
+    counter.ignore(&script);
+
+    // The script timers start with the measuring.
+    if (!scriptFile.isEmpty() && !script.load(scriptFile))
+    {
+        window.hide();
+        delete plugin;
+        delete lib.loader;
+        return 1;
+    }
+
+    script.finishAfter(duration * 1000);
+    cpuStart = cpuTime();
+    app.exec();
+    qint64 runCpu = cpuTime() - cpuStart;
+    qint64 rssAfter = residentMemory();
+
+    // Results ...................................
+    QJsonObject results;
+    results["plugin"] = pluginId;
+    results["duration_s"] = duration;
+    results["create_ms"] = createTime / 1000000.0;
+    results["create_cpu_ms"] = createCpu / 1000.0;
+    results["cpu_ms"] = runCpu / 1000.0;
+    results["cpu_percent"] = runCpu / 10000.0 / duration;
+    results["timer_wakeups"] = counter.timers();
+    results["timer_wakeups_per_minute"] = counter.timers() * 60.0 / duration;
+    results["socket_wakeups"] = counter.sockets();
+    results["socket_wakeups_per_minute"] = counter.sockets() * 60.0 / duration;
+    results["paints"] = counter.paints();
+    results["rss_kb"] = rssAfter;
+    results["plugin_rss_kb"] = rssAfter - rssBefore;
+
+    QByteArray json = QJsonDocument(results).toJson();
+    if (outFile.isEmpty())
+    {
+        QTextStream(stdout) << json;
+    }
+    else
+    {
+        QFile file(outFile);
+        if (file.open(QFile::WriteOnly))
+            file.write(json);
+        else
+            qWarning() << "Can't write" << outFile;
+    }
+
+    window.hide();
+    delete plugin;
+    lib.loader->unload();
+    delete lib.loader;
+    return 0;
+}
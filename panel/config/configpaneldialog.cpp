@@ -126,6 +126,7 @@ ConfigPanelWidget::ConfigPanelWidget(LxQtPanel *panel, QWidget *parent) :
     mBackgroundColor = mOldBackgroundColor;
     mOldBackgroundImage = mPanel->backgroundImage();
     mOldOpacity = mPanel->opacity();
+    mOldHidable = mPanel->hidable();
 
     reset();
 
@@ -138,6 +139,7 @@ ConfigPanelWidget::ConfigPanelWidget(LxQtPanel *panel, QWidget *parent) :
 
     connect(ui->comboBox_alignment,         SIGNAL(activated(int)),         this, SLOT(editChanged()));
     connect(ui->comboBox_position,          SIGNAL(activated(int)),         this, SLOT(positionChanged()));
+    connect(ui->checkBox_hidable,           SIGNAL(toggled(bool)),          this, SLOT(editChanged()));
 
     connect(ui->checkBox_customFontColor,   SIGNAL(toggled(bool)),          this, SLOT(editChanged()));
     connect(ui->pushButton_customFontColor, SIGNAL(clicked(bool)),          this, SLOT(pickFontColor()));
@@ -174,6 +176,7 @@ void ConfigPanelWidget::reset()
     ui->pushButton_customBgColor->setStyleSheet(QString("background: %1").arg(mOldBackgroundColor.name()));
     ui->lineEdit_customBgImage->setText(mOldBackgroundImage);
     ui->slider_opacity->setValue(mOldOpacity);
+    ui->checkBox_hidable->setChecked(mOldHidable);
 
     ui->checkBox_customFontColor->setChecked(mOldFontColor.isValid());
     ui->checkBox_customBgColor->setChecked(mOldBackgroundColor.isValid());
@@ -293,6 +296,7 @@ void ConfigPanelWidget::editChanged()
 
     mPanel->setAlignment(align, true);
     mPanel->setPosition(mScreenNum, mPosition, true);
+    mPanel->setHidable(ui->checkBox_hidable->isChecked(), true);
 
     mPanel->setFontColor(ui->checkBox_customFontColor->isChecked() ? mFontColor : QColor(), true);
     if (ui->checkBox_customBgColor->isChecked())
@@ -104,6 +104,7 @@ private:
     QColor mOldBackgroundColor;
     QString mOldBackgroundImage;
     int mOldOpacity;
+    bool mOldHidable;
 };
 
 #endif // CONFIGPANELDIALOG_H
@@ -30,8 +30,11 @@
 #define ILXQTPANEL_H
 #include <QRect>
 #include "lxqtpanelglobals.h"
+#include "windowproperties.h"
 
 class ILxQtPanelPlugin;
+class QObject;
+class QPixmap;
 
 /**
  **/
@@ -73,6 +76,43 @@ public:
      If you need to show some popup window, you can use it, to get global screen position for the new window.
      **/
     virtual QRect calculatePopupWindowPos(const ILxQtPanelPlugin *plugin, const QSize &windowSize) const = 0;
+
+    /**
+     Commonly used tick intervals, in milliseconds.
+     **/
+    enum TickInterval {
+        TickSecond = 1000,
+        TickMinute = 60000
+    };
+
+    /**
+     Connects the member slot of the receiver to the shared timer of the panel.
+     The slot is called on the interval boundaries (in milliseconds) of the wall
+     clock time, together with the other plugins with the same interval. Use it
+     instead of own timers for the periodic updates, so all the plugins wake up
+     the panel at once. The subscription is removed with the receiver.
+     **/
+    virtual void subscribeTick(int interval, QObject *receiver, const char *member) = 0;
+
+    /**
+     Removes all the subscriptions of the receiver.
+     **/
+    virtual void unsubscribeTick(QObject *receiver) = 0;
+
+    /**
+     Returns the cached properties of the window. The cache is shared by all
+     the panels and it's updated before the KWindowSystem signals reach the
+     plugins, so it's safe to call it from their slots. Use it instead of
+     KWindowInfo on the frequently called paths, it doesn't touch the X server.
+     **/
+    virtual WindowProperties windowProperties(WId window) const = 0;
+
+    /**
+     Returns the icon of the window for the size. The icons are shared by all
+     the panels, the windows with the same icon get the same pixmap. Returns
+     a null pixmap if the window has no icon.
+     **/
+    virtual QPixmap windowIcon(WId window, int size) const = 0;
 };
 
 #endif // ILXQTPANEL_H
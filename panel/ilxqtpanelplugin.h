@@ -166,6 +166,16 @@ public:
      **/
     virtual void realign() {}
 
+    /**
+    This function is called when the auto-hidden panel is hidden or shown again.
+    While the panel is hidden nothing of it is visible, the plugin should stop its own
+    timers and sampling. The tick subscriptions (ILxQtPanel::subscribeTick()) are paused
+    by the panel itself.
+
+    The default implementation do nothing.
+     **/
+    virtual void panelHiddenChanged(bool /*hidden*/) {}
+
     /**
     Returns the panel object.
      **/
@@ -202,7 +212,7 @@ Example:
 class LxQtClockPluginLibrary: public QObject, public ILxQtPanelPluginLibrary
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA(IID "lxde-qt.org/Panel/PluginInterface/3.0")
+    Q_PLUGIN_METADATA(IID "lxde-qt.org/Panel/PluginInterface/3.1")
     Q_INTERFACES(ILxQtPanelPluginLibrary)
 public:
     ILxQtPanelPlugin *instance(const ILxQtPanelPluginStartupInfo &startupInfo) { return new LxQtClock(startupInfo);}
@@ -225,6 +235,6 @@ public:
 
 
 Q_DECLARE_INTERFACE(ILxQtPanelPluginLibrary,
-                    "lxde-qt.org/Panel/PluginInterface/3.0")
+                    "lxde-qt.org/Panel/PluginInterface/3.1")
 
 #endif // ILXQTPANELPLUGIN_H
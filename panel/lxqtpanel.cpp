@@ -34,22 +34,37 @@
 #include "config/configpaneldialog.h"
 #include "popupmenu.h"
 #include "plugin.h"
+#include "plugindescriptorindex.h"
+#include "startuptrace.h"
+#include "tickservice.h"
+#include "windowpropertystore.h"
+#include "windowiconcache.h"
 #include <LXQt/AddPluginDialog>
 #include <LXQt/Settings>
 #include <LXQt/PluginInfo>
 
 #include <QScreen>
+#include <QCursor>
 #include <QWindow>
 #include <QX11Info>
 #include <QDebug>
 #include <QString>
 #include <QDesktopWidget>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QElapsedTimer>
+#include <QPixmap>
+#include <QImage>
+#include <QDir>
+#include <QFileInfo>
 #include <QMenu>
 #include <XdgIcon>
 #include <XdgDirs>
 
 #include <KF5/KWindowSystem/KWindowSystem>
 #include <KF5/KWindowSystem/NETWM>
+#include <xcb/xcb.h>
+#include <cstdlib>
 
 // Config keys and groups
 #define CFG_KEY_SCREENNUM          "desktop"
@@ -64,6 +79,7 @@
 #define CFG_KEY_BACKGROUNDCOLOR    "background-color"
 #define CFG_KEY_BACKGROUNDIMAGE    "background-image"
 #define CFG_KEY_OPACITY            "opacity"
+#define CFG_KEY_HIDABLE            "hidable"
 #define CFG_KEY_PLUGINS            "plugins"
 
 /************************************************
@@ -102,6 +118,225 @@ QString LxQtPanel::positionToStr(ILxQtPanel::Position position)
 }
 
 
+/************************************************
+ The panel background. It paints the background color
+ and image itself, the stylesheet isn't used for them.
+ They are rendered once for the current size, every
+ paint only copies the damaged part of the cache.
+
+ With the LXQT_PANEL_PAINT_STATS environment variable
+ the repainted area is printed every second.
+ ************************************************/
+class BackgroundWidget: public QFrame
+{
+public:
+    explicit BackgroundWidget(QWidget *parent = 0):
+        QFrame(parent),
+        mRepaintedPixels(0),
+        mStatsPixels(0),
+        mStatsPaints(0),
+        mStatsEnabled(!qgetenv("LXQT_PANEL_PAINT_STATS").isEmpty())
+    {
+        setObjectName("BackgroundWidget");
+        mStatsTimer.start();
+    }
+
+    void setBackground(const QColor &color, const QString &image)
+    {
+        if (color == mColor && image == mImageFile)
+            return;
+
+        mColor = color;
+        if (image != mImageFile)
+        {
+            mImageFile = image;
+            mImage = image.isEmpty() ? QPixmap() : QPixmap(image);
+        }
+
+        updateOpaquePaint();
+        mCache = QPixmap();
+        update();
+    }
+
+    qint64 repaintedPixels() const { return mRepaintedPixels; }
+
+protected:
+    void paintEvent(QPaintEvent *event)
+    {
+        const QVector<QRect> rects = event->region().rects();
+        countPixels(rects);
+
+        if (mColor.isValid() || !mImage.isNull())
+        {
+            if (mCache.size() != size())
+                renderCache();
+
+            // The theme background is painted before. The panel window is
+            // translucent, the color replaces the theme background, but
+            // only inside the frame.
+            QPainter painter(this);
+            painter.setClipRect(contentsRect());
+            if (mColor.isValid())
+                painter.setCompositionMode(QPainter::CompositionMode_Source);
+
+            foreach (const QRect &rect, rects)
+                painter.drawPixmap(rect, mCache, rect);
+        }
+
+        // The theme frame is drawn over the background.
+        QFrame::paintEvent(event);
+    }
+
+    void resizeEvent(QResizeEvent *event)
+    {
+        QFrame::resizeEvent(event);
+        updateOpaquePaint();
+    }
+
+    void changeEvent(QEvent *event)
+    {
+        QFrame::changeEvent(event);
+        // The theme may change the frame width.
+        if (event->type() == QEvent::StyleChange)
+            updateOpaquePaint();
+    }
+
+private:
+    QColor mColor;
+    QString mImageFile;
+    QPixmap mImage;
+    QPixmap mCache;
+
+    qint64 mRepaintedPixels;
+    qint64 mStatsPixels;
+    int mStatsPaints;
+    bool mStatsEnabled;
+    QElapsedTimer mStatsTimer;
+
+    // When the color replaces the whole widget, Qt doesn't need
+    // to paint the panel behind the damaged rects.
+    void updateOpaquePaint()
+    {
+        setAttribute(Qt::WA_OpaquePaintEvent, mColor.isValid() && contentsRect() == rect());
+    }
+
+    void renderCache()
+    {
+        mCache = QPixmap(size());
+        mCache.fill(mColor.isValid() ? mColor : Qt::transparent);
+
+        if (!mImage.isNull())
+        {
+            QPainter painter(&mCache);
+            painter.drawTiledPixmap(mCache.rect(), mImage);
+        }
+    }
+
+    void countPixels(const QVector<QRect> &rects)
+    {
+        qint64 pixels = 0;
+        foreach (const QRect &rect, rects)
+            pixels += rect.width() * rect.height();
+
+        mRepaintedPixels += pixels;
+        if (!mStatsEnabled)
+            return;
+
+        // Printed from the paint, so no timer wakes up the panel.
+        mStatsPixels += pixels;
+        mStatsPaints++;
+        if (mStatsTimer.elapsed() >= 1000)
+        {
+            qDebug() << parentWidget()->objectName() << "repainted" << mStatsPixels * 1000 / mStatsTimer.elapsed()
+                     << "px/s in" << mStatsPaints << "paints";
+            mStatsPixels = 0;
+            mStatsPaints = 0;
+            mStatsTimer.restart();
+        }
+    }
+};
+
+
+/************************************************
+ Shows the snapshot of the panel from the previous
+ run while the plugins are loaded.
+
+ The plugins are created right after it's shown and
+ the event loop doesn't run until they are done, so
+ the snapshot is also set as the background pixmap
+ of the native window. The X server paints it when
+ the window is mapped, we don't have to.
+ ************************************************/
+class SnapshotWindow: public QWidget
+{
+public:
+    SnapshotWindow(const QPixmap &snapshot, const QRect &geometry):
+        QWidget(0, Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::WindowDoesNotAcceptFocus),
+        mSnapshot(snapshot)
+    {
+        setAttribute(Qt::WA_TranslucentBackground);
+        setWindowTitle("LxQt Panel");
+        setGeometry(geometry);
+
+        // Qt::WA_X11NetWmWindowTypeDock becomes ineffective in Qt 5, see
+        // LxQtPanel::setupNativeWindow(). The window isn't mapped yet, so
+        // the properties are there when the window manager sees it.
+        WId id = winId();
+        NETWinInfo info(QX11Info::connection(), id, QX11Info::appRootWindow(), NET::WMWindowType, 0);
+        info.setWindowType(NET::Dock);
+        KWindowSystem::setOnAllDesktops(id, true);
+
+        setBackgroundPixmap(id);
+    }
+
+protected:
+    void paintEvent(QPaintEvent *event)
+    {
+        QPainter painter(this);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawPixmap(event->rect(), mSnapshot, event->rect());
+    }
+
+private:
+    QPixmap mSnapshot;
+
+    void setBackgroundPixmap(WId id)
+    {
+        xcb_connection_t *c = QX11Info::connection();
+        xcb_get_geometry_reply_t *geometry = xcb_get_geometry_reply(c, xcb_get_geometry(c, id), 0);
+        if (!geometry)
+            return;
+
+        uint8_t depth = geometry->depth;
+        free(geometry);
+        if (depth != 24 && depth != 32)
+            return;
+
+        QImage image = mSnapshot.toImage().convertToFormat(depth == 32 ? QImage::Format_ARGB32_Premultiplied
+                                                                       : QImage::Format_RGB32);
+        xcb_pixmap_t pixmap = xcb_generate_id(c);
+        xcb_create_pixmap(c, depth, pixmap, id, image.width(), image.height());
+        xcb_gcontext_t gc = xcb_generate_id(c);
+        xcb_create_gc(c, gc, pixmap, 0, 0);
+
+        // The image is sent in bands that fit into one request.
+        int maxBytes = xcb_get_maximum_request_length(c) * 4 - sizeof(xcb_put_image_request_t);
+        int rows = qMax(1, maxBytes / image.bytesPerLine());
+        for (int y = 0; y < image.height(); y += rows)
+        {
+            int height = qMin(rows, image.height() - y);
+            xcb_put_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP, pixmap, gc, image.width(), height, 0, y, 0, depth,
+                          height * image.bytesPerLine(), image.constScanLine(y));
+        }
+
+        uint32_t value = pixmap;
+        xcb_change_window_attributes(c, id, XCB_CW_BACK_PIXMAP, &value);
+        xcb_free_gc(c, gc);
+        xcb_free_pixmap(c, pixmap);
+    }
+};
+
+
 /************************************************
 
  ************************************************/
@@ -113,7 +348,17 @@ LxQtPanel::LxQtPanel(const QString &configGroup, QWidget *parent) :
     mLineCount(0),
     mLength(0),
     mAlignment(AlignmentLeft),
-    mPosition(ILxQtPanel::PositionBottom)
+    mPosition(ILxQtPanel::PositionBottom),
+    mHidable(false),
+    mHidden(false),
+    mStartupFinished(false),
+    mRealigned(false),
+    mRealignRequests(0),
+    mRealignCount(0),
+    mStrutWinId(0),
+    mStrutUpdates(0),
+    mStrutSkipped(0),
+    mSnapshotWindow(0)
 {
     Qt::WindowFlags flags = Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint;
 
@@ -137,8 +382,7 @@ LxQtPanel::LxQtPanel(const QString &configGroup, QWidget *parent) :
     setWindowTitle("LxQt Panel");
     setObjectName(QString("LxQtPanel %1").arg(configGroup));
 
-    LxQtPanelWidget = new QFrame(this);
-    LxQtPanelWidget->setObjectName("BackgroundWidget");
+    LxQtPanelWidget = new BackgroundWidget(this);
     QGridLayout* lav = new QGridLayout();
     lav->setContentsMargins(QMargins(0,0,0,0));
     setLayout(lav);
@@ -149,20 +393,25 @@ LxQtPanel::LxQtPanel(const QString &configGroup, QWidget *parent) :
     LxQtPanelWidget->setLayout(mLayout);
     mLayout->setLineCount(mLineCount);
 
-    mDelaySave.setSingleShot(true);
-    mDelaySave.setInterval(SETTINGS_SAVE_DELAY);
-    connect(&mDelaySave, SIGNAL(timeout()), this, SLOT(saveSettings()));
+    mRealignTimer.setSingleShot(true);
+    mRealignTimer.setInterval(0);
+    connect(&mRealignTimer, SIGNAL(timeout()), this, SLOT(realignNow()));
+
+    mHideTimer.setSingleShot(true);
+    mHideTimer.setInterval(PANEL_HIDE_DELAY);
+    connect(&mHideTimer, SIGNAL(timeout()), this, SLOT(hidePanelWork()));
 
-    connect(QApplication::desktop(), SIGNAL(resized(int)), this, SLOT(realign()));
+    connect(QApplication::desktop(), SIGNAL(resized(int)), this, SLOT(scheduleRealign()));
     connect(QApplication::desktop(), SIGNAL(screenCountChanged(int)), this, SLOT(ensureVisible()));
     connect(LxQt::Settings::globalSettings(), SIGNAL(settingsChanged()), this, SLOT(update()));
-    connect(lxqtApp, SIGNAL(themeChanged()), this, SLOT(realign()));
+    connect(lxqtApp, SIGNAL(themeChanged()), this, SLOT(scheduleRealign()));
 
     LxQtPanelApplication *app = reinterpret_cast<LxQtPanelApplication*>(qApp);
     mSettings = app->settings();
     readSettings();
     // the old position might be on a visible screen
     ensureVisible();
+    loadSnapshot();
     loadPlugins();
 
     show();
@@ -205,23 +454,18 @@ void LxQtPanel::readSettings()
     if (!image.isEmpty())
         setBackgroundImage(image, false);
 
+    setHidable(mSettings->value(CFG_KEY_HIDABLE, false).toBool(), false);
 
     mSettings->endGroup();
 }
 
 
 /************************************************
-
+ The values are kept in memory, the SettingsModel
+ writes them to the disk later.
  ************************************************/
-void LxQtPanel::saveSettings(bool later)
+void LxQtPanel::saveSettings()
 {
-    mDelaySave.stop();
-    if (later)
-    {
-        mDelaySave.start();
-        return;
-    }
-
     QStringList pluginsList;
 
     mSettings->beginGroup(mConfigGroup);
@@ -247,6 +491,7 @@ void LxQtPanel::saveSettings(bool later)
     mSettings->setValue(CFG_KEY_BACKGROUNDCOLOR, mBackgroundColor.isValid() ? mBackgroundColor : QColor());
     mSettings->setValue(CFG_KEY_BACKGROUNDIMAGE, QFileInfo(mBackgroundImage).exists() ? mBackgroundImage : QString());
     mSettings->setValue(CFG_KEY_OPACITY, mOpacity);
+    mSettings->setValue(CFG_KEY_HIDABLE, mHidable);
 
     mSettings->endGroup();
 }
@@ -273,6 +518,7 @@ LxQtPanel::~LxQtPanel()
     mLayout->setEnabled(false);
     // do not save settings because of "user deleted panel" functionality saveSettings();
     qDeleteAll(mPlugins);
+    delete mSnapshotWindow;
 }
 
 
@@ -286,25 +532,11 @@ void LxQtPanel::show()
 }
 
 
-/************************************************
-
- ************************************************/
-QStringList pluginDesktopDirs()
-{
-    QStringList dirs;
-    dirs << QString(getenv("LXQT_PANEL_PLUGINS_DIR")).split(':', QString::SkipEmptyParts);
-    dirs << QString("%1/%2").arg(XdgDirs::dataHome(), "/lxqt/lxqt-panel");
-    dirs << PLUGIN_DESKTOPS_DIR;
-    return dirs;
-}
-
-
 /************************************************
 
  ************************************************/
 void LxQtPanel::loadPlugins()
 {
-    QStringList desktopDirs = pluginDesktopDirs();
     mSettings->beginGroup(mConfigGroup);
     QStringList sections = mSettings->value(CFG_KEY_PLUGINS).toStringList();
     mSettings->endGroup();
@@ -318,14 +550,14 @@ void LxQtPanel::loadPlugins()
             continue;
         }
 
-        LxQt::PluginInfoList list = LxQt::PluginInfo::search(desktopDirs, "LxQtPanel/Plugin", QString("%1.desktop").arg(type));
-        if( !list.count())
+        LxQt::PluginInfo info = PluginDescriptorIndex::instance()->find(type);
+        if (!info.isValid())
         {
             qWarning() << QString("Plugin \"%1\" not found.").arg(type);
             continue;
         }
 
-        loadPlugin(list.first(), sect);
+        loadPlugin(info, sect);
     }
 }
 
@@ -335,12 +567,16 @@ void LxQtPanel::loadPlugins()
  ************************************************/
 Plugin *LxQtPanel::loadPlugin(const LxQt::PluginInfo &desktopFile, const QString &settingsGroup)
 {
-    Plugin *plugin = new Plugin(desktopFile, mSettings->fileName(), settingsGroup, this);
+    TraceSpan span("loadPlugin", settingsGroup);
+    LxQtPanelApplication *app = reinterpret_cast<LxQtPanelApplication*>(qApp);
+    Plugin *plugin = new Plugin(desktopFile, app->settingsModel(), settingsGroup, this);
     if (plugin->isLoaded())
     {
         mPlugins.append(plugin);
         connect(plugin, SIGNAL(startMove()), mLayout, SLOT(startMovePlugin()));
         connect(plugin, SIGNAL(remove()), this, SLOT(removePlugin()));
+        connect(plugin, SIGNAL(loaded()), this, SLOT(pluginLoaded()));
+        connect(plugin, SIGNAL(painted()), this, SLOT(checkStartupFinished()), Qt::QueuedConnection);
         connect(this, SIGNAL(realigned()), plugin, SLOT(realign()));
         mLayout->addWidget(plugin);
         return plugin;
@@ -351,6 +587,31 @@ Plugin *LxQtPanel::loadPlugin(const LxQt::PluginInfo &desktopFile, const QString
 }
 
 
+/************************************************
+ The setters can be called many times in a row (readSettings(),
+ the spinboxes of the config dialog), all of them are merged
+ into one realign on the next event loop iteration.
+ ************************************************/
+void LxQtPanel::scheduleRealign()
+{
+    mRealignRequests++;
+    if (!mRealignTimer.isActive())
+        mRealignTimer.start();
+}
+
+
+/************************************************
+
+ ************************************************/
+void LxQtPanel::realignNow()
+{
+    mRealignTimer.stop();
+    mRealignCount++;
+    realign();
+    emit realigned();
+}
+
+
 /************************************************
 
  ************************************************/
@@ -358,6 +619,8 @@ void LxQtPanel::realign()
 {
     if (!isVisible())
         return;
+
+    qint64 traceStart = StartupTrace::isEnabled() ? StartupTrace::now() : 0;
 #if 0
     qDebug() << "** Realign *********************";
     qDebug() << "PanelSize:   " << mPanelSize;
@@ -455,6 +718,31 @@ void LxQtPanel::realign()
         else
             rect.moveRight(currentScreen.right());
     }
+
+    // The hidden panel leaves only a thin strip on the screen edge,
+    // the pointer entering it shows the panel.
+    if (mHidden)
+    {
+        switch (mPosition)
+        {
+        case LxQtPanel::PositionTop:
+            rect.moveBottom(currentScreen.top() + PANEL_HIDE_SIZE - 1);
+            break;
+
+        case LxQtPanel::PositionBottom:
+            rect.moveTop(currentScreen.bottom() - PANEL_HIDE_SIZE + 1);
+            break;
+
+        case LxQtPanel::PositionLeft:
+            rect.moveRight(currentScreen.left() + PANEL_HIDE_SIZE - 1);
+            break;
+
+        case LxQtPanel::PositionRight:
+            rect.moveLeft(currentScreen.right() - PANEL_HIDE_SIZE + 1);
+            break;
+        }
+    }
+
     if (rect != geometry())
     {
         setGeometry(rect);
@@ -462,8 +750,15 @@ void LxQtPanel::realign()
     }
     // Reserve our space on the screen ..........
     // It's possible that our geometry is not changed, but screen resolution is changed,
-    // so resetting WM_STRUT is still needed. To make it simple, we always do it.
+    // updateWmStrut() checks both of them.
     updateWmStrut();
+
+    if (!mRealigned)
+    {
+        mRealigned = true;
+        if (StartupTrace::isEnabled())
+            StartupTrace::addSpan("first realign", mConfigGroup, traceStart, StartupTrace::now() - traceStart);
+    }
 }
 
 
@@ -482,45 +777,59 @@ void LxQtPanel::updateWmStrut()
     // So, we use the geometry of the whole screen to calculate the strut rather than using the geometry of individual monitors.
     // Though the spec only mention Xinerama and did not mention XRandR, the rule should still be applied.
     // At least openbox is implemented like this.
+    //                   Left       Right      Top        Bottom
+    //                   w, s, e    w, s, e    w, s, e    w, s, e
+    QVector<int> strut(12, 0);
     switch (mPosition)
     {
     case LxQtPanel::PositionTop:
-        KWindowSystem::setExtendedStrut(wid,
-                                        /* Left   */  0, 0, 0,
-                                        /* Right  */  0, 0, 0,
-                                        /* Top    */  height(), rect.left(), rect.right(),
-                                        /* Bottom */  0, 0, 0
-                                       );
+        strut[6] = height();
+        strut[7] = rect.left();
+        strut[8] = rect.right();
         break;
 
     case LxQtPanel::PositionBottom:
-        KWindowSystem::setExtendedStrut(wid,
-                                        /* Left   */  0, 0, 0,
-                                        /* Right  */  0, 0, 0,
-                                        /* Top    */  0, 0, 0,
-                                        /* Bottom */  wholeScreen.bottom() - rect.y(), rect.left(), rect.right()
-                                       );
+        strut[9]  = wholeScreen.bottom() - rect.y();
+        strut[10] = rect.left();
+        strut[11] = rect.right();
         break;
 
     case LxQtPanel::PositionLeft:
-        KWindowSystem::setExtendedStrut(wid,
-                                        /* Left   */  width(), rect.top(), rect.bottom(),
-                                        /* Right  */  0, 0, 0,
-                                        /* Top    */  0, 0, 0,
-                                        /* Bottom */  0, 0, 0
-                                       );
-
+        strut[0] = width();
+        strut[1] = rect.top();
+        strut[2] = rect.bottom();
         break;
 
     case LxQtPanel::PositionRight:
-        KWindowSystem::setExtendedStrut(wid,
-                                        /* Left   */  0, 0, 0,
-                                        /* Right  */  wholeScreen.right() - rect.x(), rect.top(), rect.bottom(),
-                                        /* Top    */  0, 0, 0,
-                                        /* Bottom */  0, 0, 0
-                                       );
+        strut[3] = wholeScreen.right() - rect.x();
+        strut[4] = rect.top();
+        strut[5] = rect.bottom();
         break;
     }
+
+    // The auto-hidden panel gives its space back to the windows.
+    if (mHidable)
+        strut.fill(0);
+
+    // Every new strut makes the window manager rearrange the maximized
+    // windows, so send it only when something is really changed.
+    if (wid == mStrutWinId && wholeScreen == mStrutScreen && strut == mStrut)
+    {
+        mStrutSkipped++;
+        return;
+    }
+
+    mStrutWinId = wid;
+    mStrutScreen = wholeScreen;
+    mStrut = strut;
+    mStrutUpdates++;
+
+    KWindowSystem::setExtendedStrut(wid,
+                                    /* Left   */  strut[0], strut[1], strut[2],
+                                    /* Right  */  strut[3], strut[4], strut[5],
+                                    /* Top    */  strut[6], strut[7], strut[8],
+                                    /* Bottom */  strut[9], strut[10], strut[11]
+                                   );
 }
 
 
@@ -601,7 +910,7 @@ void LxQtPanel::showAddPluginDialog()
 
     if (!dialog)
     {
-        dialog = new LxQt::AddPluginDialog(pluginDesktopDirs(), "LxQtPanel/Plugin", "*", this);
+        dialog = new LxQt::AddPluginDialog(PluginDescriptorIndex::instance()->desktopDirs(), "LxQtPanel/Plugin", "*", this);
         dialog->setWindowTitle(tr("Add Panel Widgets"));
         dialog->setAttribute(Qt::WA_DeleteOnClose);
         connect(dialog, SIGNAL(pluginSelected(const LxQt::PluginInfo&)), this, SLOT(addPlugin(const LxQt::PluginInfo&)));
@@ -626,43 +935,54 @@ void LxQtPanel::addPlugin(const LxQt::PluginInfo &desktopFile)
 {
     QString settingsGroup = findNewPluginSettingsGroup(desktopFile.id());
     loadPlugin(desktopFile, settingsGroup);
-    saveSettings(true);
+    saveSettings();
 
-    realign();
-    emit realigned();
+    scheduleRealign();
 
     emit pluginAdded(desktopFile.id());
 }
 
 
 /************************************************
-
+ The icon size, the font color and the background were
+ delivered with the stylesheet before. Any change of the
+ stylesheet repolishes all plugin widgets, so now each
+ of them is updated in its own way.
  ************************************************/
-void LxQtPanel::updateStyleSheet()
+void LxQtPanel::updateIconSize()
 {
-    QStringList sheet;
-    sheet << QString("Plugin > * { qproperty-iconSize: %1px %1px; }").arg(mIconSize);
-    sheet << QString("Plugin > * > * { qproperty-iconSize: %1px %1px; }").arg(mIconSize);
+    foreach (Plugin *plugin, mPlugins)
+        plugin->updateIconSize();
+}
 
+
+/************************************************
+
+ ************************************************/
+void LxQtPanel::updateFontColor()
+{
+    // The themes set the color of the panel widgets in their stylesheets,
+    // which win over the palette, so the font color stays a stylesheet rule.
+    // It's the only rule of the panel, the other settings don't repolish
+    // the plugins.
     if (mFontColor.isValid())
-        sheet << QString("Plugin * { color: " + mFontColor.name() + "; }");
+        setStyleSheet(QString("Plugin * { color: %1; }").arg(mFontColor.name()));
+    else
+        setStyleSheet(QString());
+}
 
-    QString object = LxQtPanelWidget->objectName();
 
-    if (mBackgroundColor.isValid())
-    {
-        QString color = QString("%1, %2, %3, %4")
-            .arg(mBackgroundColor.red())
-            .arg(mBackgroundColor.green())
-            .arg(mBackgroundColor.blue())
-            .arg((float) mOpacity / 100);
-        sheet << QString("LxQtPanel #BackgroundWidget { background-color: rgba(" + color + "); }");
-    }
+/************************************************
 
-    if (QFileInfo(mBackgroundImage).exists())
-        sheet << QString("LxQtPanel #BackgroundWidget { background-image: url('" + mBackgroundImage + "');}");
+ ************************************************/
+void LxQtPanel::updateBackground()
+{
+    QColor color = mBackgroundColor;
+    if (color.isValid())
+        color.setAlphaF(mOpacity / 100.0);
 
-    setStyleSheet(sheet.join("\n"));
+    LxQtPanelWidget->setBackground(color,
+                                   QFileInfo(mBackgroundImage).exists() ? mBackgroundImage : QString());
 }
 
 
@@ -675,11 +995,10 @@ void LxQtPanel::setPanelSize(int value, bool save)
     if (mPanelSize != value)
     {
         mPanelSize = value;
-        realign();
-        emit realigned();
+        scheduleRealign();
 
         if (save)
-            saveSettings(true);
+            saveSettings();
     }
 }
 
@@ -693,14 +1012,13 @@ void LxQtPanel::setIconSize(int value, bool save)
     if (mIconSize != value)
     {
         mIconSize = value;
-        updateStyleSheet();
+        updateIconSize();
         mLayout->setLineSize(mIconSize);
 
         if (save)
-            saveSettings(true);
+            saveSettings();
 
-        realign();
-        emit realigned();
+        scheduleRealign();
     }
 }
 
@@ -718,10 +1036,9 @@ void LxQtPanel::setLineCount(int value, bool save)
         mLayout->setEnabled(true);
 
         if (save)
-            saveSettings(true);
+            saveSettings();
 
-        realign();
-        emit realigned();
+        scheduleRealign();
     }
 }
 
@@ -739,10 +1056,9 @@ void LxQtPanel::setLength(int length, bool inPercents, bool save)
     mLengthInPercents = inPercents;
 
     if (save)
-        saveSettings(true);
+        saveSettings();
 
-    realign();
-    emit realigned();
+    scheduleRealign();
 }
 
 
@@ -760,7 +1076,7 @@ void LxQtPanel::setPosition(int screen, ILxQtPanel::Position position, bool save
     mLayout->setPosition(mPosition);
 
     if (save)
-        saveSettings(true);
+        saveSettings();
 
     // Qt 5 adds a new class QScreen and add API for setting the screen of a QWindow.
     // so we had better use it. However, without this, our program should still work
@@ -784,8 +1100,7 @@ void LxQtPanel::setPosition(int screen, ILxQtPanel::Position position, bool save
         windowHandle()->setScreen(qApp->screens().at(screen));
     }
 
-    realign();
-    emit realigned();
+    scheduleRealign();
 }
 
 /************************************************
@@ -799,10 +1114,9 @@ void LxQtPanel::setAlignment(Alignment value, bool save)
     mAlignment = value;
 
     if (save)
-        saveSettings(true);
+        saveSettings();
 
-    realign();
-    emit realigned();
+    scheduleRealign();
 }
 
 /************************************************
@@ -811,10 +1125,10 @@ void LxQtPanel::setAlignment(Alignment value, bool save)
 void LxQtPanel::setFontColor(QColor color, bool save)
 {
     mFontColor = color;
-    updateStyleSheet();
+    updateFontColor();
 
     if (save)
-        saveSettings(true);
+        saveSettings();
 }
 
 /************************************************
@@ -823,10 +1137,10 @@ void LxQtPanel::setFontColor(QColor color, bool save)
 void LxQtPanel::setBackgroundColor(QColor color, bool save)
 {
     mBackgroundColor = color;
-    updateStyleSheet();
+    updateBackground();
 
     if (save)
-        saveSettings(true);
+        saveSettings();
 }
 
 /************************************************
@@ -835,10 +1149,10 @@ void LxQtPanel::setBackgroundColor(QColor color, bool save)
 void LxQtPanel::setBackgroundImage(QString path, bool save)
 {
     mBackgroundImage = path;
-    updateStyleSheet();
+    updateBackground();
 
     if (save)
-        saveSettings(true);
+        saveSettings();
 }
 
 
@@ -848,10 +1162,33 @@ void LxQtPanel::setBackgroundImage(QString path, bool save)
 void LxQtPanel::setOpacity(int opacity, bool save)
 {
     mOpacity = opacity;
-    updateStyleSheet();
+    updateBackground();
 
     if (save)
-        saveSettings(true);
+        saveSettings();
+}
+
+
+/************************************************
+
+ ************************************************/
+void LxQtPanel::setHidable(bool hidable, bool save)
+{
+    if (mHidable == hidable)
+        return;
+
+    mHidable = hidable;
+
+    if (mHidable)
+        hidePanel();
+    else
+        showPanel();
+
+    // The strut is changed.
+    scheduleRealign();
+
+    if (save)
+        saveSettings();
 }
 
 
@@ -876,8 +1213,23 @@ bool LxQtPanel::event(QEvent *event)
         break;
 
     case QEvent::LayoutRequest:
-        realign();
-        emit realigned();
+        scheduleRealign();
+        break;
+
+    case QEvent::Paint:
+        // The panel is on the screen.
+        if (mSnapshotWindow)
+            releaseSnapshot();
+        if (!mStartupFinished)
+            QMetaObject::invokeMethod(this, "checkStartupFinished", Qt::QueuedConnection);
+        break;
+
+    case QEvent::Enter:
+        showPanel();
+        break;
+
+    case QEvent::Leave:
+        hidePanel();
         break;
 
     case QEvent::WinIdChange:
@@ -890,15 +1242,7 @@ bool LxQtPanel::event(QEvent *event)
         // the winId() may be changed at runtime. So we need to reset all X11 properties
         // when this happens.
         qDebug() << "WinIdChange" << hex << effectiveWinId() << "handle" << windowHandle() << windowHandle()->screen();
-
-        // Qt::WA_X11NetWmWindowTypeDock becomes ineffective in Qt 5
-        // See QTBUG-39887: https://bugreports.qt-project.org/browse/QTBUG-39887
-        // Let's do it manually
-        NETWinInfo info(QX11Info::connection(), effectiveWinId(), QX11Info::appRootWindow(), NET::WMWindowType, 0);
-        info.setWindowType(NET::Dock);
-
-        updateWmStrut(); // reserve screen space for the panel
-        KWindowSystem::setOnAllDesktops(effectiveWinId(), true);
+        setupNativeWindow();
         break;
     }
     default:
@@ -915,8 +1259,301 @@ bool LxQtPanel::event(QEvent *event)
 void LxQtPanel::showEvent(QShowEvent *event)
 {
     QFrame::showEvent(event);
+    realignNow();
+}
+
+
+/************************************************
+
+ ************************************************/
+void LxQtPanel::setupNativeWindow()
+{
+    // Qt::WA_X11NetWmWindowTypeDock becomes ineffective in Qt 5
+    // See QTBUG-39887: https://bugreports.qt-project.org/browse/QTBUG-39887
+    // Let's do it manually
+    NETWinInfo info(QX11Info::connection(), effectiveWinId(), QX11Info::appRootWindow(), NET::WMWindowType, 0);
+    info.setWindowType(NET::Dock);
+
+    mStrutWinId = 0; // the new window has no strut yet
+    updateWmStrut(); // reserve screen space for the panel
+    KWindowSystem::setOnAllDesktops(effectiveWinId(), true);
+}
+
+
+/************************************************
+ The screen of the panel is going away. The plugins
+ and their state are kept, only the native window is
+ moved or re-created.
+ ************************************************/
+void LxQtPanel::moveToScreen(QScreen *screen)
+{
+    QWindow *window = windowHandle();
+    if (!window)
+        return;
+
+    // The old screen number is stale now, the panel is placed like
+    // in the constructor, see ensureVisible().
+    mScreenNum = qMax(0, qApp->screens().indexOf(screen));
+    if (!canPlacedOn(mScreenNum, mPosition))
+        mScreenNum = findAvailableScreen(mPosition);
+    saveSettings();
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
+    // The screens of one X screen (XRandR) share the root window,
+    // Qt moves the window without re-creating it.
+    if (screen && window->screen() && window->screen()->virtualSiblings().contains(screen))
+    {
+        window->setScreen(screen);
+        scheduleRealign();
+        return;
+    }
+#endif
+
+    // The native window has to be re-created. Qt doesn't send the
+    // WinIdChange for it (Qt 5 bug #40681), so we do it ourselves.
+    // The native child windows die with it: the XEMBED clients of the
+    // tray wouldn't dock again while the tray keeps its selection. The
+    // plugins owning native windows are unloaded first and loaded again
+    // on the new window, so the tray announces itself to the clients anew.
+    QList<int> reloaded;
+    QList<int> layoutIndexes;
+    QList<LxQt::PluginInfo> desktopFiles;
+    QStringList settingsGroups;
+    for (int i = mPlugins.count() - 1; i >= 0; --i)
+    {
+        Plugin *plugin = mPlugins.at(i);
+        if (!plugin->hasNativeWindows())
+            continue;
+
+        reloaded.prepend(i);
+        layoutIndexes.prepend(mLayout->indexOf(plugin));
+        desktopFiles.prepend(plugin->desktopFile());
+        settingsGroups.prepend(plugin->settingsGroup());
+        mPlugins.removeAt(i);
+        delete plugin;
+    }
+
+    bool visible = isVisible();
+    hide();
+    destroy(true, true);
+
+    // The new window is put on the target screen before it's shown.
+    create();
+    if (screen && windowHandle())
+        windowHandle()->setScreen(screen);
+
+    for (int i = 0; i < reloaded.count(); ++i)
+    {
+        Plugin *plugin = loadPlugin(desktopFiles.at(i), settingsGroups.at(i));
+        if (!plugin)
+            continue;
+
+        mPlugins.move(mPlugins.count() - 1, qMin(reloaded.at(i), mPlugins.count() - 1));
+        mLayout->moveItem(mLayout->indexOf(plugin), layoutIndexes.at(i));
+    }
+
+    if (visible)
+    {
+        show();
+        setupNativeWindow();
+    }
     realign();
-    emit realigned();
+}
+
+
+/************************************************
+
+ ************************************************/
+qint64 LxQtPanel::repaintedPixels() const
+{
+    return LxQtPanelWidget->repaintedPixels();
+}
+
+
+/************************************************
+
+ ************************************************/
+QString LxQtPanel::snapshotFile() const
+{
+    return QString("%1/lxqt-panel/%2.snapshot.png").arg(XdgDirs::cacheHome(), mConfigGroup);
+}
+
+
+/************************************************
+ The plugins remember their sizes on exit, not on
+ every realign().
+ ************************************************/
+void LxQtPanel::saveLazyHints()
+{
+    foreach (Plugin *plugin, mPlugins)
+        plugin->saveLazyHints();
+}
+
+
+/************************************************
+ The snapshot is written on exit with the panel
+ placement, it's used only if the placement and
+ the screens are the same on the next start.
+ ************************************************/
+void LxQtPanel::saveSnapshot()
+{
+    if (!isVisible() || mHidden)
+        return;
+
+    QImage image = grab().toImage();
+    const QRect rect = geometry();
+    const QRect desktop = QApplication::desktop()->geometry();
+    image.setText("geometry", QString("%1 %2 %3 %4").arg(rect.x()).arg(rect.y()).arg(rect.width()).arg(rect.height()));
+    image.setText("desktop", QString("%1 %2").arg(desktop.width()).arg(desktop.height()));
+    image.setText("position", QString("%1 %2").arg(mScreenNum).arg(positionToStr(mPosition)));
+
+    QDir().mkpath(QFileInfo(snapshotFile()).absolutePath());
+    if (!image.save(snapshotFile(), "PNG"))
+        qWarning() << "Can't write the panel snapshot" << snapshotFile();
+}
+
+
+/************************************************
+ Called before the plugins are loaded, the window with
+ the snapshot is shown at once. It's closed when the
+ panel paints itself, the placeholders of the lazy
+ plugins paint their part of the snapshot until they
+ are loaded.
+ ************************************************/
+void LxQtPanel::loadSnapshot()
+{
+    QImage image(snapshotFile());
+    if (image.isNull())
+        return;
+
+    const QRect desktop = QApplication::desktop()->geometry();
+    QStringList geometry = image.text("geometry").split(' ');
+    if (geometry.count() != 4 ||
+        image.text("desktop") != QString("%1 %2").arg(desktop.width()).arg(desktop.height()) ||
+        image.text("position") != QString("%1 %2").arg(mScreenNum).arg(positionToStr(mPosition)))
+        return;
+
+    mSnapshotGeometry = QRect(geometry[0].toInt(), geometry[1].toInt(), geometry[2].toInt(), geometry[3].toInt());
+    if (mSnapshotGeometry.size() != image.size())
+        return;
+
+    TraceSpan span("snapshot", mConfigGroup);
+    mSnapshot = QPixmap::fromImage(image);
+    mSnapshotWindow = new SnapshotWindow(mSnapshot, mSnapshotGeometry);
+    mSnapshotWindow->show();
+
+    // Map it now, the plugins block the event loop and its flush.
+    xcb_flush(QX11Info::connection());
+}
+
+
+/************************************************
+
+ ************************************************/
+bool LxQtPanel::paintSnapshot(QWidget *widget, QPainter *painter) const
+{
+    if (mSnapshot.isNull() || geometry() != mSnapshotGeometry)
+        return false;
+
+    QPoint pos = widget->mapTo(const_cast<LxQtPanel*>(this), QPoint(0, 0));
+    painter->drawPixmap(widget->rect(), mSnapshot, QRect(pos, widget->size()));
+    return true;
+}
+
+
+/************************************************
+ The window is closed when the panel is painted, the
+ picture is kept while some plugin is a placeholder.
+ ************************************************/
+void LxQtPanel::releaseSnapshot()
+{
+    if (mSnapshotWindow)
+    {
+        mSnapshotWindow->deleteLater();
+        mSnapshotWindow = 0;
+    }
+
+    foreach (const Plugin *plugin, mPlugins)
+    {
+        if (plugin->isPlaceholder())
+            return;
+    }
+
+    mSnapshot = QPixmap();
+}
+
+
+/************************************************
+
+ ************************************************/
+void LxQtPanel::showPanel()
+{
+    mHideTimer.stop();
+    if (mHidden)
+        setPanelHidden(false);
+}
+
+
+/************************************************
+
+ ************************************************/
+void LxQtPanel::hidePanel()
+{
+    if (mHidable && !mHidden)
+        mHideTimer.start();
+}
+
+
+/************************************************
+
+ ************************************************/
+void LxQtPanel::hidePanelWork()
+{
+    if (!mHidable || mHidden)
+        return;
+
+    // The pointer is back or a menu of the panel is open.
+    if (geometry().contains(QCursor::pos()) || QApplication::activePopupWidget())
+    {
+        mHideTimer.start();
+        return;
+    }
+
+    setPanelHidden(true);
+}
+
+
+/************************************************
+ Only a strip of the hidden panel is on the screen. It's
+ still painted, so it follows the theme and background
+ changes, but the plugins don't update: their ticks are
+ paused. On showing, the paused ticks come at once and
+ the plugins catch up.
+ ************************************************/
+void LxQtPanel::setPanelHidden(bool hidden)
+{
+    mHidden = hidden;
+
+    if (mHidden)
+    {
+        TickService::instance()->setPaused(this, true);
+        foreach (Plugin *plugin, mPlugins)
+            plugin->setPanelHidden(true);
+
+        // Only the position is changed, the plugins don't need to realign.
+        realign();
+
+        if (!mStartupFinished)
+            QMetaObject::invokeMethod(this, "checkStartupFinished", Qt::QueuedConnection);
+    }
+    else
+    {
+        realign();
+
+        foreach (Plugin *plugin, mPlugins)
+            plugin->setPanelHidden(false);
+        TickService::instance()->setPaused(this, false);
+    }
 }
 
 
@@ -1053,6 +1690,42 @@ QRect LxQtPanel::calculatePopupWindowPos(const ILxQtPanelPlugin *plugin, const Q
 }
 
 
+/************************************************
+
+ ************************************************/
+void LxQtPanel::subscribeTick(int interval, QObject *receiver, const char *member)
+{
+    TickService::instance()->subscribe(this, interval, receiver, member);
+}
+
+
+/************************************************
+
+ ************************************************/
+void LxQtPanel::unsubscribeTick(QObject *receiver)
+{
+    TickService::instance()->unsubscribe(this, receiver);
+}
+
+
+/************************************************
+
+ ************************************************/
+WindowProperties LxQtPanel::windowProperties(WId window) const
+{
+    return WindowPropertyStore::instance()->properties(window);
+}
+
+
+/************************************************
+
+ ************************************************/
+QPixmap LxQtPanel::windowIcon(WId window, int size) const
+{
+    return WindowIconCache::instance()->icon(window, size);
+}
+
+
 /************************************************
 
  ************************************************/
@@ -1095,6 +1768,46 @@ void LxQtPanel::removePlugin()
 }
 
 
+/************************************************
+ The lazy plugin is built, now we know its real properties.
+ ************************************************/
+void LxQtPanel::pluginLoaded()
+{
+    Plugin *plugin = qobject_cast<Plugin*>(sender());
+    if (!plugin)
+        return;
+
+    mLayout->rebuild();
+    plugin->realign();
+
+    if (!mSnapshot.isNull())
+        releaseSnapshot();
+}
+
+
+/************************************************
+ The start is finished when the panel and all its
+ plugins have been painted. The plugins that don't
+ paint are done: the ones without a widget or with
+ a hidden widget, the lazy placeholders and all the
+ plugins of a hidden panel.
+ ************************************************/
+void LxQtPanel::checkStartupFinished()
+{
+    if (mStartupFinished)
+        return;
+
+    foreach (const Plugin *plugin, mPlugins)
+    {
+        if (!mHidden && !plugin->isPlaceholder() && !plugin->isPainted())
+            return;
+    }
+
+    mStartupFinished = true;
+    emit startupFinished();
+}
+
+
 /************************************************
 
  ************************************************/
@@ -30,13 +30,19 @@
 #define LXQTPANEL_H
 
 #include <QFrame>
+#include <QPixmap>
 #include <QString>
 #include <QTimer>
+#include <QVector>
 #include "ilxqtpanel.h"
 #include "lxqtpanelglobals.h"
 
 class QMenu;
+class QScreen;
 class Plugin;
+class BackgroundWidget;
+class SnapshotWindow;
+class QPainter;
 
 namespace LxQt {
 class Settings;
@@ -68,10 +74,21 @@ public:
 
     void showPopupMenu(Plugin *plugin = 0);
 
+    void moveToScreen(QScreen *screen);
+
+    // The picture of the panel from the previous run, see loadSnapshot().
+    void saveSnapshot();
+    bool paintSnapshot(QWidget *widget, QPainter *painter) const;
+    void saveLazyHints();
+
     // ILxQtPanel .........................
     ILxQtPanel::Position position() const { return mPosition; }
     QRect globalGometry() const;
     QRect calculatePopupWindowPos(const ILxQtPanelPlugin *plugin, const QSize &windowSize) const;
+    void subscribeTick(int interval, QObject *receiver, const char *member);
+    void unsubscribeTick(QObject *receiver);
+    WindowProperties windowProperties(WId window) const;
+    QPixmap windowIcon(WId window, int size) const;
 
     // For QSS properties ..................
     QString qssPosition() const;
@@ -92,9 +109,19 @@ public:
     QColor backgroundColor() const { return mBackgroundColor; };
     QString backgroundImage() const { return mBackgroundImage; };
     int opacity() const { return mOpacity; };
+    bool hidable() const { return mHidable; }
+    bool isPanelHidden() const { return mHidden; }
+    bool isStartupFinished() const { return mStartupFinished; }
 
     LxQt::Settings *settings() const { return mSettings; }
 
+    // Statistics
+    int realignRequests() const { return mRealignRequests; }
+    int realignCount() const { return mRealignCount; }
+    int strutUpdates() const { return mStrutUpdates; }
+    int strutSkipped() const { return mStrutSkipped; }
+    qint64 repaintedPixels() const;
+
 public slots:
     void show();
 
@@ -109,13 +136,15 @@ public slots:
     void setBackgroundColor(QColor color, bool save);
     void setBackgroundImage(QString path, bool save);
     void setOpacity(int opacity, bool save);
+    void setHidable(bool hidable, bool save);
 
-    void saveSettings(bool later=false);
+    void saveSettings();
     void ensureVisible();
 
 signals:
     void realigned();
     void deletedByUser(LxQtPanel *self);
+    void startupFinished();
 
     void pluginAdded(QString id);
     void pluginRemoved(QString id);
@@ -128,15 +157,21 @@ private slots:
     void addPlugin(const LxQt::PluginInfo &desktopFile);
     void showConfigDialog();
     void showAddPluginDialog();
-    void realign();
+    void scheduleRealign();
+    void realignNow();
     void removePlugin();
     void pluginMoved();
+    void pluginLoaded();
+    void checkStartupFinished();
     void userRequestForDeletion();
+    void showPanel();
+    void hidePanel();
+    void hidePanelWork();
 
 private:
     LxQtPanelLayout* mLayout;
     LxQt::Settings *mSettings;
-    QFrame *LxQtPanelWidget;
+    BackgroundWidget *LxQtPanelWidget;
     QString mConfigGroup;
     QList<Plugin*> mPlugins;
 
@@ -160,7 +195,6 @@ private:
 
     ILxQtPanel::Position mPosition;
     int mScreenNum;
-    QTimer mDelaySave;
 
     QColor mFontColor;
     QColor mBackgroundColor;
@@ -168,7 +202,36 @@ private:
     // 0 to 100
     int mOpacity;
 
-    void updateStyleSheet();
+    bool mHidable;
+    bool mHidden;
+    bool mStartupFinished;
+    QTimer mHideTimer;
+
+    bool mRealigned;
+    QTimer mRealignTimer;
+    int mRealignRequests;
+    int mRealignCount;
+
+    WId mStrutWinId;
+    QRect mStrutScreen;
+    QVector<int> mStrut;
+    int mStrutUpdates;
+    int mStrutSkipped;
+
+    void realign();
+    void setPanelHidden(bool hidden);
+    void setupNativeWindow();
+
+    QPixmap mSnapshot;
+    QRect mSnapshotGeometry;
+    SnapshotWindow *mSnapshotWindow;
+    QString snapshotFile() const;
+    void loadSnapshot();
+    void releaseSnapshot();
+
+    void updateIconSize();
+    void updateFontColor();
+    void updateBackground();
 };
 
 
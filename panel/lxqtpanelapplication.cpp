@@ -28,6 +28,13 @@
 
 #include "lxqtpanelapplication.h"
 #include "lxqtpanel.h"
+#include "pluginlibraryloader.h"
+#include "startuptrace.h"
+#include "settingsmodel.h"
+#include "wakeupstats.h"
+#include "stallwatchdog.h"
+#include "windowpropertystore.h"
+#include "windowiconcache.h"
 #include "config/configpaneldialog.h"
 #include <LXQt/Settings>
 #include <QtDebug>
@@ -38,10 +45,8 @@
 LxQtPanelApplication::LxQtPanelApplication(int& argc, char** argv, const QString &configFile)
     : LxQt::Application(argc, argv)
 {
-    if (configFile.isEmpty())
-        mSettings = new LxQt::Settings("panel", this);
-    else
-        mSettings = new LxQt::Settings(configFile, QSettings::IniFormat, this);
+    mSettingsModel = new SettingsModel(configFile, this);
+    mSettings = mSettingsModel->settings();
 
     // This is a workaround for Qt 5 bug #40681.
     Q_FOREACH(QScreen* screen, screens())
@@ -57,6 +62,21 @@ LxQtPanelApplication::LxQtPanelApplication(int& argc, char** argv, const QString
         panels << "panel1";
     }
 
+    // Start loading the plugin libraries of all panels in the worker threads,
+    // the panels pick them up in the configured order.
+    QStringList pluginTypes;
+    Q_FOREACH(QString i, panels)
+    {
+        QStringList sections = mSettings->value(i + "/plugins").toStringList();
+        Q_FOREACH(QString sect, sections)
+            pluginTypes << mSettings->value(sect + "/type").toString();
+    }
+    PluginLibraryLoader::instance()->preload(pluginTypes);
+
+    // The caches must get the window signals before the plugins.
+    WindowPropertyStore::instance();
+    WindowIconCache::instance();
+
     Q_FOREACH(QString i, panels)
     {
         addPanel(i);
@@ -68,6 +88,48 @@ LxQtPanelApplication::~LxQtPanelApplication()
     qDeleteAll(mPanels);
 }
 
+
+/************************************************
+ Counts the timer and socket wakeups of the GUI
+ thread for each plugin when WakeupStats is
+ enabled. With the
+ StallWatchdog all the events are tagged with the
+ plugin they are dispatched to.
+ ************************************************/
+bool LxQtPanelApplication::notify(QObject *receiver, QEvent *event)
+{
+    if (receiver->thread() != thread())
+        return LxQt::Application::notify(receiver, event);
+
+    StallWatchdog *watchdog = StallWatchdog::instance();
+    WakeupStats *stats = WakeupStats::instance();
+    QEvent::Type type = event->type();
+    bool wakeup = stats->isEnabled() && (type == QEvent::Timer || type == QEvent::SockAct);
+    if (!wakeup && !watchdog)
+        return LxQt::Application::notify(receiver, event);
+
+    // The receiver can be deleted by the handler, find the plugin before.
+    Plugin *plugin = stats->findPlugin(receiver);
+
+    StallWatchdog::Context context;
+    if (watchdog)
+        context = watchdog->enter(plugin, receiver, type);
+
+    qint64 accounted = stats->accountedTime();
+    qint64 start = wakeup ? WakeupStats::threadCpuTime() : 0;
+    bool res = LxQt::Application::notify(receiver, event);
+    if (wakeup)
+    {
+        qint64 nested = stats->accountedTime() - accounted;
+        stats->addWakeup(plugin, type, WakeupStats::threadCpuTime() - start - nested);
+    }
+
+    if (watchdog)
+        watchdog->leave(context);
+
+    return res;
+}
+
 void LxQtPanelApplication::addNewPanel()
 {
     QString name("panel_" + QUuid::createUuid().toString());
@@ -82,46 +144,35 @@ void LxQtPanelApplication::addNewPanel()
 
 LxQtPanel* LxQtPanelApplication::addPanel(const QString& name)
 {
+    TraceSpan span("addPanel", name);
     LxQtPanel *panel = new LxQtPanel(name);
     mPanels << panel;
     connect(panel, SIGNAL(deletedByUser(LxQtPanel*)),
             this, SLOT(removePanel(LxQtPanel*)));
+    connect(panel, SIGNAL(startupFinished()), this, SLOT(panelStartupFinished()));
     return panel;
 }
 
-void LxQtPanelApplication::handleScreenAdded(QScreen* newScreen)
+/************************************************
+ The trace is written as soon as all panels are up, the
+ panel doesn't have to be closed to get it. It's written
+ again on exit with the spans recorded since.
+ ************************************************/
+void LxQtPanelApplication::panelStartupFinished()
 {
-    // qDebug() << "LxQtPanelApplication::handleScreenAdded" << newScreen;
-    connect(newScreen, &QScreen::destroyed, this, &LxQtPanelApplication::screenDestroyed);
+    Q_FOREACH(LxQtPanel *panel, mPanels)
+    {
+        if (!panel->isStartupFinished())
+            return;
+    }
+
+    StartupTrace::save();
 }
 
-void LxQtPanelApplication::reloadPanelsAsNeeded()
+void LxQtPanelApplication::handleScreenAdded(QScreen* newScreen)
 {
-    // NOTE by PCMan: This is a workaround for Qt 5 bug #40681.
-    // Here we try to re-create the missing panels which are deleted in
-    // LxQtPanelApplication::screenDestroyed().
-
-    // qDebug() << "LxQtPanelApplication::reloadPanelsAsNeeded()";
-    QStringList names = mSettings->value("panels").toStringList();
-    Q_FOREACH(const QString& name, names)
-    {
-        bool found = false;
-        Q_FOREACH(LxQtPanel* panel, mPanels)
-        {
-            if(panel->name() == name)
-            {
-                found = true;
-                break;
-            }
-        }
-        if(!found)
-        {
-            // the panel is found in the config file but does not exist, create it.
-            qDebug() << "Workaround Qt 5 bug #40681: re-create panel:" << name;
-            addPanel(name);
-        }
-    }
-    qApp->setQuitOnLastWindowClosed(true);
+    // qDebug() << "LxQtPanelApplication::handleScreenAdded" << newScreen;
+    connect(newScreen, &QScreen::destroyed, this, &LxQtPanelApplication::screenDestroyed);
 }
 
 void LxQtPanelApplication::screenDestroyed(QObject* screenObj)
@@ -148,30 +199,35 @@ void LxQtPanelApplication::screenDestroyed(QObject* screenObj)
     // some X11 window properties using the native winId() to make it a dock, but this stop working
     // because we cannot get the correct winId(), so this causes #204 and #205.
     //
-    // The workaround is very simple. Just completely destroy the panel before Qt has a chance to do
-    // QWindow::setScreen() for it. Later, we reload the panel ourselves. So this can bypassing the Qt bugs.
+    // The workaround: we move the panel away before Qt has a chance to do QWindow::setScreen()
+    // for it. The panel, its plugins and their state are kept, only the native window is moved
+    // or re-created, see LxQtPanel::moveToScreen().
     QScreen* screen = static_cast<QScreen*>(screenObj);
-    bool reloadNeeded = false;
+    QScreen* target = primaryScreen();
+    if (target == screen)
+    {
+        target = 0;
+        Q_FOREACH(QScreen* s, screens())
+        {
+            if (s != screen)
+            {
+                target = s;
+                break;
+            }
+        }
+    }
+
     qApp->setQuitOnLastWindowClosed(false);
     Q_FOREACH(LxQtPanel* panel, mPanels)
     {
         QWindow* panelWindow = panel->windowHandle();
         if(panelWindow && panelWindow->screen() == screen)
         {
-            // the screen containing the panel is destroyed
-            // delete and then re-create the panel ourselves
-            QString name = panel->name();
-            panel->saveSettings(false);
-            delete panel; // delete the panel, so Qt does not have a chance to set a new screen to it.
-            mPanels.removeAll(panel);
-            reloadNeeded = true;
-            qDebug() << "Workaround Qt 5 bug #40681: delete panel:" << name;
+            qDebug() << "Workaround Qt 5 bug #40681: move panel:" << panel->name() << "to" << target;
+            panel->moveToScreen(target);
         }
     }
-    if(reloadNeeded)
-        QTimer::singleShot(1000, this, SLOT(reloadPanelsAsNeeded()));
-    else
-        qApp->setQuitOnLastWindowClosed(true);
+    qApp->setQuitOnLastWindowClosed(true);
 }
 
 void LxQtPanelApplication::removePanel(LxQtPanel* panel)
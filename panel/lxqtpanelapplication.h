@@ -35,6 +35,7 @@
 class QScreen;
 
 class LxQtPanel;
+class SettingsModel;
 namespace LxQt {
 class Settings;
 }
@@ -47,7 +48,11 @@ public:
     ~LxQtPanelApplication();
 
     int count() { return mPanels.count(); }
+    QList<LxQtPanel*> panels() const { return mPanels; }
     LxQt::Settings *settings() { return mSettings; }
+    SettingsModel *settingsModel() { return mSettingsModel; }
+
+    bool notify(QObject *receiver, QEvent *event);
 
 public slots:
     void addNewPanel();
@@ -59,12 +64,13 @@ private:
 
 private slots:
     void removePanel(LxQtPanel* panel);
+    void panelStartupFinished();
 
     void handleScreenAdded(QScreen* newScreen);
     void screenDestroyed(QObject* screenObj);
-    void reloadPanelsAsNeeded();
 
 private:
+    SettingsModel *mSettingsModel;
     LxQt::Settings *mSettings;
 };
 
@@ -101,7 +101,10 @@ LayoutItemInfo::LayoutItemInfo(QLayoutItem *layoutItem):
 
 /************************************************
   This is logical plugins grid, it's same for
-  horizontal and vertical panel. Plugins keeps as:
+  horizontal and vertical panel. The size hints of
+  the items are cached, the layout invalidates only
+  the items that have been changed.
+  Plugins keeps as:
 
    <---LineCount-->
    + ---+----+----+
@@ -130,6 +133,11 @@ public:
 
     void update();
 
+    QSize itemSizeHint(QLayoutItem *item);
+    bool invalidateItem(QObject *widget);
+    void clearCache();
+    int sizeHintCount() const { return mSizeHintCount; }
+
     int lineSize() const { return mLineSize; }
     void setLineSize(int value);
 
@@ -173,6 +181,8 @@ private:
     int mNextCol;
     bool mExpandable;
     QList<QLayoutItem*> mItems;
+    QHash<const QLayoutItem*, QSize> mSizeHints;
+    int mSizeHintCount;
 
     void doAddToGrid(QLayoutItem *item);
 };
@@ -183,6 +193,7 @@ private:
  ************************************************/
 LayoutItemGrid::LayoutItemGrid()
 {
+    mSizeHintCount = 0;
     mLineSize = 0;
     mHoriz = true;
     clear();
@@ -274,6 +285,7 @@ void LayoutItemGrid::doAddToGrid(QLayoutItem *item)
 QLayoutItem *LayoutItemGrid::takeAt(int index)
 {
     QLayoutItem *item = mItems.takeAt(index);
+    mSizeHints.remove(item);
     rebuild();
     return item;
 }
@@ -307,6 +319,58 @@ LayoutItemInfo &LayoutItemGrid::itemInfo(int row, int col)
 }
 
 
+/************************************************
+
+ ************************************************/
+QSize LayoutItemGrid::itemSizeHint(QLayoutItem *item)
+{
+    // Only plugins tell us about their changes, see LxQtPanelLayout::eventFilter().
+    if (!qobject_cast<Plugin*>(item->widget()))
+    {
+        mSizeHintCount++;
+        return item->sizeHint();
+    }
+
+    QHash<const QLayoutItem*, QSize>::const_iterator it = mSizeHints.constFind(item);
+    if (it != mSizeHints.constEnd())
+        return it.value();
+
+    mSizeHintCount++;
+    QSize sz = item->sizeHint();
+    mSizeHints.insert(item, sz);
+    return sz;
+}
+
+
+/************************************************
+ Returns true if the widget belongs to this grid.
+ ************************************************/
+bool LayoutItemGrid::invalidateItem(QObject *widget)
+{
+    foreach (QLayoutItem *item, mItems)
+    {
+        if (item->widget() == widget)
+        {
+            mSizeHints.remove(item);
+            invalidate();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/************************************************
+
+ ************************************************/
+void LayoutItemGrid::clearCache()
+{
+    mSizeHints.clear();
+    invalidate();
+}
+
+
 /************************************************
 
  ************************************************/
@@ -329,7 +393,7 @@ void LayoutItemGrid::update()
                 if (!info.item)
                     continue;
 
-                QSize sz = info.item->sizeHint();
+                QSize sz = itemSizeHint(info.item);
                 info.geometry = QRect(QPoint(x,y), sz);
                 y += sz.height();
                 rw = qMax(rw, sz.width());
@@ -357,7 +421,7 @@ void LayoutItemGrid::update()
                 if (!info.item)
                     continue;
 
-                QSize sz = info.item->sizeHint();
+                QSize sz = itemSizeHint(info.item);
                 info.geometry = QRect(QPoint(x,y), sz);
                 x += sz.width();
                 rh = qMax(rh, sz.height());
@@ -382,7 +446,7 @@ void LayoutItemGrid::update()
 void LayoutItemGrid::setLineSize(int value)
 {
     mLineSize = qMax(1, value);
-    invalidate();
+    clearCache();
 }
 
 
@@ -401,7 +465,7 @@ void LayoutItemGrid::setColCount(int value)
 void LayoutItemGrid::setHoriz(bool value)
 {
     mHoriz = value;
-    invalidate();
+    clearCache();
 }
 
 
@@ -414,7 +478,9 @@ LxQtPanelLayout::LxQtPanelLayout(QWidget *parent) :
     mLeftGrid(new LayoutItemGrid()),
     mRightGrid(new LayoutItemGrid()),
     mPosition(ILxQtPanel::PositionBottom),
-    mAnimate(false)
+    mAnimate(false),
+    mGeometryCount(0),
+    mSkippedGeometryCount(0)
 {
     setMargin(0);
 }
@@ -441,6 +507,10 @@ void LxQtPanelLayout::addItem(QLayoutItem *item)
     if (p && p->alignment() == Plugin::AlignLeft)
         grid = mLeftGrid;
 
+    // We need to know when the size hint of the plugin is changed.
+    if (p)
+        p->installEventFilter(this);
+
     grid->addItem(item);
 }
 
@@ -506,7 +576,12 @@ QLayoutItem *LxQtPanelLayout::takeAt(int index)
     int idx=0;
     globalIndexToLocal(index, &grid, &idx);
 
-    return grid->takeAt(idx);
+    QLayoutItem *item = grid->takeAt(idx);
+    mItemGeometries.remove(item);
+    if (item->widget())
+        item->widget()->removeEventFilter(this);
+
+    return item;
 }
 
 
@@ -617,8 +692,21 @@ void LxQtPanelLayout::setItemGeometry(QLayoutItem *item, const QRect &geometry,
     }
     else
     {
+        // Don't touch the plugins that stay on the same place.
+        QHash<const QLayoutItem*, QRect>::iterator it = mItemGeometries.find(item);
+        if (it != mItemGeometries.end() && it.value() == geometry)
+        {
+            mSkippedGeometryCount++;
+            return;
+        }
+
+        mGeometryCount++;
         item->setGeometry(geometry);
+        mItemGeometries.insert(item, geometry);
+        return;
     }
+
+    mItemGeometries.remove(item);
 }
 
 
@@ -855,6 +943,88 @@ void LxQtPanelLayout::invalidate()
 }
 
 
+/************************************************
+ Call it when the separate or expandable flags of
+ some plugin are changed.
+ ************************************************/
+void LxQtPanelLayout::rebuild()
+{
+    clearCache();
+    mLeftGrid->rebuild();
+    mRightGrid->rebuild();
+    invalidate();
+}
+
+
+/************************************************
+
+ ************************************************/
+void LxQtPanelLayout::clearCache()
+{
+    mLeftGrid->clearCache();
+    mRightGrid->clearCache();
+    mItemGeometries.clear();
+}
+
+
+/************************************************
+
+ ************************************************/
+void LxQtPanelLayout::invalidateItem(QObject *widget)
+{
+    if (!mLeftGrid->invalidateItem(widget))
+        mRightGrid->invalidateItem(widget);
+
+    for (int i=0; i<count(); ++i)
+    {
+        QLayoutItem *item = itemAt(i);
+        if (item->widget() == widget)
+        {
+            mItemGeometries.remove(item);
+            break;
+        }
+    }
+}
+
+
+/************************************************
+ Qt calls invalidate() when any plugin asks for a new
+ geometry, but it doesn't tell which one. The plugin
+ gets the LayoutRequest (or style, font, visibility
+ change) before the layout is recalculated, so we
+ invalidate only this plugin.
+ ************************************************/
+bool LxQtPanelLayout::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type())
+    {
+    case QEvent::LayoutRequest:
+    case QEvent::StyleChange:
+    case QEvent::FontChange:
+    case QEvent::Show:
+    case QEvent::Hide:
+    case QEvent::ShowToParent:
+    case QEvent::HideToParent:
+        invalidateItem(watched);
+        break;
+
+    default:
+        break;
+    }
+
+    return QLayout::eventFilter(watched, event);
+}
+
+
+/************************************************
+
+ ************************************************/
+int LxQtPanelLayout::sizeHintCount() const
+{
+    return mLeftGrid->sizeHintCount() + mRightGrid->sizeHintCount();
+}
+
+
 /************************************************
 
  ************************************************/
@@ -871,6 +1041,7 @@ void LxQtPanelLayout::setLineCount(int value)
 {
     mLeftGrid->setColCount(value);
     mRightGrid->setColCount(value);
+    mItemGeometries.clear();
     invalidate();
 }
 
@@ -903,6 +1074,7 @@ void LxQtPanelLayout::setPosition(ILxQtPanel::Position value)
     mPosition = value;
     mLeftGrid->setHoriz(isHorizontal());
     mRightGrid->setHoriz(isHorizontal());
+    mItemGeometries.clear();
 }
 
 
@@ -30,6 +30,7 @@
 #define LXQTPANELLAYOUT_H
 
 #include <QLayout>
+#include <QHash>
 #include <QList>
 #include <QWidget>
 #include <QLayoutItem>
@@ -63,6 +64,7 @@ public:
     bool isHorizontal() const;
 
     void invalidate();
+    void rebuild();
 
     int lineCount() const;
     void setLineCount(int value);
@@ -74,6 +76,12 @@ public:
     void setPosition(ILxQtPanel::Position value);
 
     static bool itemIsSeparate(QLayoutItem *item);
+
+    // Statistics
+    int sizeHintCount() const;
+    int geometryCount() const { return mGeometryCount; }
+    int skippedGeometryCount() const { return mSkippedGeometryCount; }
+
 signals:
     void pluginMoved();
 
@@ -81,12 +89,18 @@ public slots:
     void startMovePlugin();
     void finishMovePlugin();
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event);
+
 private:
     mutable QSize mMinPluginSize;
     LayoutItemGrid *mLeftGrid;
     LayoutItemGrid *mRightGrid;
     ILxQtPanel::Position mPosition;
     bool mAnimate;
+    QHash<const QLayoutItem*, QRect> mItemGeometries;
+    int mGeometryCount;
+    int mSkippedGeometryCount;
 
 
     void setGeometryHoriz(const QRect &geometry);
@@ -95,6 +109,8 @@ private:
     void globalIndexToLocal(int index, LayoutItemGrid **grid, int *gridIndex) const;
 
     void setItemGeometry(QLayoutItem *item, const QRect &geometry, bool withAnimation);
+    void invalidateItem(QObject *widget);
+    void clearCache();
 };
 
 #endif // LXQTPANELLAYOUT_H
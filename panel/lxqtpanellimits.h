@@ -38,4 +38,8 @@
 #define PANEL_DEFAULT_BACKGROUND_COLOR "#CCCCCC"
 
 #define SETTINGS_SAVE_DELAY 3000
+
+// Auto-hide: the size of the part left on the screen and the delay before hiding.
+#define PANEL_HIDE_SIZE 4
+#define PANEL_HIDE_DELAY 500
 #endif // LXQTPANELLIMITS_H
@@ -35,6 +35,14 @@
 
 #include "lxqtpanelapplication.h"
 #include "lxqtpanel.h"
+#include "plugindescriptorindex.h"
+#include "settingsmodel.h"
+#include "startuptrace.h"
+#include "tickservice.h"
+#include "wakeupstats.h"
+#include "stallwatchdog.h"
+#include "windowpropertystore.h"
+#include "windowiconcache.h"
 
 /*! The lxqt-panel is the panel of LXDE-Qt.
   Usage: lxqt-panel [CONFIG_ID]
@@ -69,8 +77,37 @@ void printVersion()
 }
 
 
+/************************************************
+ The counters of the run, see LXQT_PANEL_STATS.
+ ************************************************/
+void printStats(LxQtPanelApplication *app)
+{
+    PluginDescriptorIndex *index = PluginDescriptorIndex::instance();
+    qDebug() << "Plugin descriptors:" << index->lookupCount() << "lookups,"
+             << index->scanCount() << "directory scans,"
+             << index->parseCount() << "parsed files,"
+             << index->elapsed() << "ms"
+             << (index->fromDiskCache() ? "(cached)" : "");
+    qDebug() << "Settings flushes:" << app->settingsModel()->flushCount();
+    qDebug() << "Tick wakeups:" << TickService::instance()->wakeupCount();
+    qDebug() << "Window properties:" << WindowPropertyStore::instance()->hitCount() << "cached reads,"
+             << WindowPropertyStore::instance()->fetchCount() << "fetches in"
+             << WindowPropertyStore::instance()->batchCount() << "batches";
+    qDebug() << "Window icons:" << WindowIconCache::instance()->hitCount() << "hits,"
+             << WindowIconCache::instance()->missCount() << "misses";
+    foreach (LxQtPanel *panel, app->panels())
+        qDebug() << "Panel" << panel->name() << "realigns:" << panel->realignCount()
+                 << "of" << panel->realignRequests() << "requested,"
+                 << "strut updates:" << panel->strutUpdates()
+                 << "skipped:" << panel->strutSkipped()
+                 << "repainted pixels:" << panel->repaintedPixels();
+}
+
+
 int main(int argc, char *argv[])
 {
+    StartupTrace::init();
+
     QString configFile;
     for (int i=1; i < argc; ++i)
     {
@@ -108,8 +145,29 @@ int main(int argc, char *argv[])
     sigaction(SIGTERM, &term, 0);
     sigaction(SIGINT,  &term, 0);
 
+    // Print the plugin wakeups on SIGUSR1
+    WakeupStats::instance()->installDumpSignal();
+
+    // Report the event loop stalls, see LXQT_PANEL_STALL
+    StallWatchdog::init();
+
     bool res = app->exec();
 
+    StartupTrace::save();
+    foreach (LxQtPanel *panel, app->panels())
+    {
+        panel->saveSnapshot();
+        panel->saveLazyHints();
+    }
+
+    // The event loop is gone, deliver the write requests of
+    // the settings by hand and write the hints at once.
+    QCoreApplication::sendPostedEvents(0, QEvent::UpdateRequest);
+    app->settingsModel()->flush();
+
+    if (WakeupStats::statsRequested())
+        printStats(app);
+
     app->deleteLater();
     return res;
 }
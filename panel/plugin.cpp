@@ -29,8 +29,11 @@
 #include "plugin.h"
 #include "ilxqtpanelplugin.h"
 #include "lxqtpanel.h"
+#include "pluginlibraryloader.h"
+#include "startuptrace.h"
+#include "settingsmodel.h"
+#include "wakeupstats.h"
 #include <QDebug>
-#include <QProcessEnvironment>
 #include <QStringList>
 #include <QDir>
 #include <QFileInfo>
@@ -41,18 +44,26 @@
 #include <QMenu>
 #include <QMouseEvent>
 #include <QApplication>
-#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QMetaProperty>
+#include <QPainter>
+#include <QTimer>
 
-#include <LXQt/Settings>
 #include <LXQt/Translator>
 #include <XdgIcon>
 
+// Config keys
+#define CFG_KEY_LAZY            "lazy"
+#define CFG_KEY_LAZY_SIZE       "lazy-size"
+#define CFG_KEY_LAZY_SEPARATE   "lazy-separate"
+#define CFG_KEY_LAZY_EXPANDABLE "lazy-expandable"
+
 QColor Plugin::mMoveMarkerColor= QColor(255, 0, 0, 255);
 
 /************************************************
 
  ************************************************/
-Plugin::Plugin(const LxQt::PluginInfo &desktopFile, const QString &settingsFile, const QString &settingsGroup, LxQtPanel *panel) :
+Plugin::Plugin(const LxQt::PluginInfo &desktopFile, SettingsModel *settingsModel, const QString &settingsGroup, LxQtPanel *panel) :
     QFrame(panel),
     mDesktopFile(desktopFile),
     mPluginLoader(0),
@@ -60,46 +71,69 @@ Plugin::Plugin(const LxQt::PluginInfo &desktopFile, const QString &settingsFile,
     mPluginWidget(0),
     mAlignment(AlignLeft),
     mSettingsGroup(settingsGroup),
-    mPanel(panel)
+    mPanel(panel),
+    mLazy(false),
+    mPlaceholder(false),
+    mSeparate(false),
+    mExpandable(false),
+    mPainted(false),
+    mLoadedAt(0)
 {
 
-    mSettings = new LxQt::Settings(settingsFile, QSettings::IniFormat, this);
-    connect(mSettings, SIGNAL(settingsChanged()), this, SLOT(settingsChanged()));
-    mSettings->beginGroup(settingsGroup);
-
-    mSettingsHash = calcSettingsHash();
+    mSettings = settingsModel->groupView(settingsGroup, this);
+    connect(settingsModel, SIGNAL(groupChanged(QString)), this, SLOT(settingsChanged(QString)));
 
     setWindowTitle(desktopFile.name());
     mName = desktopFile.name();
 
-    QStringList dirs;
-    dirs << QProcessEnvironment::systemEnvironment().value("LXQTPANEL_PLUGIN_PATH").split(":");
-    dirs << PLUGIN_DIR;
-
-    QString baseName = QString("lib%1.so").arg(desktopFile.id());
-    bool found = false;
-    foreach(QString dirName, dirs)
+    mLibrary = PluginLibraryLoader::instance()->take(desktopFile.id());
+    if (!mLibrary.loader)
     {
-        QFileInfo fi(QDir(dirName), baseName);
-
-        if (fi.exists())
-        {
-            found = true;
-            if (loadLib(fi.absoluteFilePath()))
-                break;
-        }
+        if (!mLibrary.found)
+            qWarning() << QString("Plugin %1 not found in the").arg(PluginLibraryLoader::libraryFileName(desktopFile.id()))
+                       << PluginLibraryLoader::libraryDirs();
+        else
+            qWarning() << mLibrary.error;
+
+        return;
     }
 
-    if (!isLoaded())
+    // The lazy plugin is built when the panel is already painted, the
+    // place for it is reserved using the values from the previous start.
+    mLazy = mSettings->value(CFG_KEY_LAZY, false).toBool();
+    QString s = mSettings->value("alignment").toString();
+    mPlaceholderSize = mSettings->value(CFG_KEY_LAZY_SIZE).toSize();
+    if (mLazy && !s.isEmpty() && mPlaceholderSize.isValid())
     {
-        if (!found)
-            qWarning() << QString("Plugin %1 not found in the").arg(baseName) << dirs;
-
+        mPlaceholder = true;
+        mSeparate = mSettings->value(CFG_KEY_LAZY_SEPARATE, false).toBool();
+        mExpandable = mSettings->value(CFG_KEY_LAZY_EXPANDABLE, false).toBool();
+        mAlignment = (s.toUpper() == "RIGHT") ?
+                    Plugin::AlignRight :
+                    Plugin::AlignLeft;
+        setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
         return;
     }
 
+    load();
+}
+
+
+/************************************************
+
+ ************************************************/
+bool Plugin::load()
+{
+    mPlaceholder = false;
+
+    if (!loadLib(mLibrary))
+        return false;
+
+    WakeupStats::instance()->addPlugin(this, dynamic_cast<QObject*>(mPlugin),
+                                       QString("%1 (%2)").arg(settingsGroup(), mDesktopFile.id()));
+
     // Load plugin translations
-    LxQt::Translator::translatePlugin(desktopFile.id(), QLatin1String("lxqt-panel"));
+    LxQt::Translator::translatePlugin(mDesktopFile.id(), QLatin1String("lxqt-panel"));
 
     setObjectName(mPlugin->themeId() + "Plugin");
     QString s = mSettings->value("alignment").toString();
@@ -127,9 +161,33 @@ Plugin::Plugin(const LxQt::PluginInfo &desktopFile, const QString &settingsFile,
         layout->setContentsMargins(0, 0, 0, 0);
         setLayout(layout);
         layout->addWidget(mPluginWidget, 0, 0);
+
+        // The children created later get the icon size when they are polished.
+        mPluginWidget->installEventFilter(this);
+        updateIconSize();
     }
 
+    mLoadedAt = StartupTrace::now();
     saveSettings();
+    return true;
+}
+
+
+/************************************************
+
+ ************************************************/
+void Plugin::loadDeferred()
+{
+    if (!mPlaceholder)
+        return;
+
+    if (!load())
+    {
+        hide();
+        return;
+    }
+
+    emit loaded();
 }
 
 
@@ -138,12 +196,18 @@ Plugin::Plugin(const LxQt::PluginInfo &desktopFile, const QString &settingsFile,
  ************************************************/
 Plugin::~Plugin()
 {
+    WakeupStats::instance()->removePlugin(this);
     delete mPlugin;
     if (mPluginLoader)
     {
         mPluginLoader->unload();
         delete mPluginLoader;
     }
+    else
+    {
+        // The placeholder was never built.
+        delete mLibrary.loader;
+    }
 }
 
 void Plugin::setAlignment(Plugin::Alignment alignment)
@@ -156,15 +220,12 @@ void Plugin::setAlignment(Plugin::Alignment alignment)
 /************************************************
 
  ************************************************/
-bool Plugin::loadLib(const QString &libraryName)
+bool Plugin::loadLib(const PluginLibraryLoader::Result &lib)
 {
-    mPluginLoader = new QPluginLoader(libraryName);
+    mPluginLoader = lib.loader;
 
-    if (!mPluginLoader->load())
-    {
-        qWarning() << mPluginLoader->errorString();
-        return false;
-    }
+    QElapsedTimer timer;
+    timer.start();
 
     QObject *obj = mPluginLoader->instance();
     if (!obj)
@@ -186,52 +247,49 @@ bool Plugin::loadLib(const QString &libraryName)
     startupInfo.desktopFile = &mDesktopFile;
     startupInfo.lxqtPanel = mPanel;
 
-    mPlugin = pluginLib->instance(startupInfo);
+    {
+        TraceSpan span("instance()", mSettingsGroup);
+        mPlugin = pluginLib->instance(startupInfo);
+    }
     if (!mPlugin)
     {
         qWarning() << QString("Can't load plugin \"%1\". Plugin can't build ILxQtPanelPlugin.").arg(mPluginLoader->fileName());
         delete obj;
         return false;
     }
+    qint64 instanceTime = timer.restart();
 
-    mPluginWidget = mPlugin->widget();
+    {
+        TraceSpan span("widget()", mSettingsGroup);
+        mPluginWidget = mPlugin->widget();
+    }
     if (mPluginWidget)
     {
         mPluginWidget->setObjectName(mPlugin->themeId());
     }
     this->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    qint64 widgetTime = timer.elapsed();
 
-    return true;
-}
+    if (WakeupStats::statsRequested())
+        qDebug() << QString("Plugin %1: resolve %2 ms, load %3 ms, wait %4 ms, instance %5 ms, widget %6 ms")
+                    .arg(mSettingsGroup)
+                    .arg(lib.resolveTime)
+                    .arg(lib.loadTime)
+                    .arg(lib.waitTime)
+                    .arg(instanceTime)
+                    .arg(widgetTime);
 
-
-/************************************************
-
- ************************************************/
-QByteArray Plugin::calcSettingsHash()
-{
-    QCryptographicHash hash(QCryptographicHash::Md5);
-    QStringList keys = mSettings->allKeys();
-    foreach (const QString &key, keys)
-    {
-        hash.addData(key.toUtf8());
-        hash.addData(mSettings->value(key).toByteArray());
-    }
-    return hash.result();
+    return true;
 }
 
 
 /************************************************
 
  ************************************************/
-void Plugin::settingsChanged()
+void Plugin::settingsChanged(const QString &group)
 {
-    QByteArray hash = calcSettingsHash();
-    if (mSettingsHash != hash)
-    {
-        mSettingsHash = hash;
+    if (mPlugin && group == mSettingsGroup)
         mPlugin->settingsChanged();
-    }
 }
 
 
@@ -240,10 +298,12 @@ void Plugin::settingsChanged()
  ************************************************/
 void Plugin::saveSettings()
 {
-    mSettings->setValue("alignment", (mAlignment == AlignLeft) ? "Left" : "Right");
-    mSettings->setValue("type", mDesktopFile.id());
-    mSettings->sync();
+    QString alignment = (mAlignment == AlignLeft) ? "Left" : "Right";
+    if (mSettings->value("alignment").toString() != alignment)
+        mSettings->setValue("alignment", alignment);
 
+    if (mSettings->value("type").toString() != mDesktopFile.id())
+        mSettings->setValue("type", mDesktopFile.id());
 }
 
 
@@ -252,6 +312,10 @@ void Plugin::saveSettings()
  ************************************************/
 void Plugin::contextMenuEvent(QContextMenuEvent *event)
 {
+    loadDeferred();
+    if (!mPlugin)
+        return;
+
     mPanel->showPopupMenu(this);
 }
 
@@ -261,6 +325,11 @@ void Plugin::contextMenuEvent(QContextMenuEvent *event)
  ************************************************/
 void Plugin::mousePressEvent(QMouseEvent *event)
 {
+    // The click on the placeholder builds the plugin and goes to it.
+    loadDeferred();
+    if (!mPlugin)
+        return;
+
     switch (event->button())
     {
     case Qt::LeftButton:
@@ -282,6 +351,9 @@ void Plugin::mousePressEvent(QMouseEvent *event)
  ************************************************/
 void Plugin::mouseDoubleClickEvent(QMouseEvent*)
 {
+    if (!mPlugin)
+        return;
+
     mPlugin->activated(ILxQtPanelPlugin::DoubleClick);
 }
 
@@ -296,6 +368,144 @@ void Plugin::showEvent(QShowEvent *)
 }
 
 
+/************************************************
+
+ ************************************************/
+void Plugin::enterEvent(QEvent *event)
+{
+    // The user is going to use the plugin, don't wait for the idle time.
+    loadDeferred();
+    QFrame::enterEvent(event);
+}
+
+
+/************************************************
+
+ ************************************************/
+void Plugin::paintEvent(QPaintEvent *event)
+{
+    // The panel is on the screen, now we have time to build the lazy plugin.
+    if (mPlaceholder)
+    {
+        QTimer::singleShot(0, this, SLOT(loadDeferred()));
+
+        // Until then the picture from the previous run is shown.
+        QPainter painter(this);
+        mPanel->paintSnapshot(this, &painter);
+    }
+
+    QFrame::paintEvent(event);
+}
+
+
+/************************************************
+
+ ************************************************/
+void Plugin::setPanelHidden(bool hidden)
+{
+    if (mPlugin)
+        mPlugin->panelHiddenChanged(hidden);
+}
+
+
+/************************************************
+ The native child windows (e.g. the XEMBED tray icons)
+ are destroyed together with the native window of
+ the panel.
+ ************************************************/
+bool Plugin::hasNativeWindows() const
+{
+    if (!mPluginWidget)
+        return false;
+
+    if (mPluginWidget->testAttribute(Qt::WA_NativeWindow))
+        return true;
+
+    foreach (const QWidget *child, mPluginWidget->findChildren<QWidget*>())
+    {
+        if (child->testAttribute(Qt::WA_NativeWindow))
+            return true;
+    }
+
+    return false;
+}
+
+
+/************************************************
+ The plugin widget and its children get the panel icon
+ size through their "iconSize" property.
+ ************************************************/
+void Plugin::updateIconSize()
+{
+    if (!mPluginWidget)
+        return;
+
+    applyIconSize(mPluginWidget);
+    foreach (QObject *child, mPluginWidget->children())
+    {
+        if (child->isWidgetType())
+            applyIconSize(child);
+    }
+}
+
+
+/************************************************
+
+ ************************************************/
+void Plugin::applyIconSize(QObject *object) const
+{
+    const QMetaObject *meta = object->metaObject();
+    int index = meta->indexOfProperty("iconSize");
+    if (index < 0)
+        return;
+
+    QMetaProperty property = meta->property(index);
+    if (!property.isWritable() || property.type() != QVariant::Size)
+        return;
+
+    QSize size(mPanel->iconSize(), mPanel->iconSize());
+    if (property.read(object).toSize() != size)
+        property.write(object, size);
+}
+
+
+/************************************************
+
+ ************************************************/
+bool Plugin::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == mPluginWidget && event->type() == QEvent::ChildPolished)
+    {
+        QObject *child = static_cast<QChildEvent*>(event)->child();
+        if (child->isWidgetType())
+            applyIconSize(child);
+    }
+
+    // The plugin is on the screen from its first paint.
+    if (watched == mPluginWidget && event->type() == QEvent::Paint && !mPainted)
+    {
+        mPainted = true;
+        if (StartupTrace::isEnabled())
+            StartupTrace::addSpan("first paint", mSettingsGroup, mLoadedAt, StartupTrace::now() - mLoadedAt);
+        emit painted();
+    }
+
+    return QFrame::eventFilter(watched, event);
+}
+
+
+/************************************************
+
+ ************************************************/
+QSize Plugin::sizeHint() const
+{
+    if (mPlaceholder)
+        return mPlaceholderSize;
+
+    return QFrame::sizeHint();
+}
+
+
 /************************************************
 
  ************************************************/
@@ -334,7 +544,10 @@ QMenu *Plugin::popupMenu() const
  ************************************************/
 bool Plugin::isSeparate() const
 {
-   return mPlugin->isSeparate();
+    if (!mPlugin)
+        return mSeparate;
+
+    return mPlugin->isSeparate();
 }
 
 
@@ -343,6 +556,9 @@ bool Plugin::isSeparate() const
  ************************************************/
 bool Plugin::isExpandable() const
 {
+    if (!mPlugin)
+        return mExpandable;
+
     return mPlugin->isExpandable();
 }
 
@@ -352,8 +568,34 @@ bool Plugin::isExpandable() const
  ************************************************/
 void Plugin::realign()
 {
-    if (mPlugin)
-        mPlugin->realign();
+    if (!mPlugin)
+        return;
+
+    mPlugin->realign();
+}
+
+
+/************************************************
+ Remembers what the layout needs to know about the
+ plugin before it's built. Called on exit.
+ ************************************************/
+void Plugin::saveLazyHints()
+{
+    if (!mLazy || !mPlugin)
+        return;
+
+    QSize size = sizeHint();
+    if (size.isValid() && size != mPlaceholderSize)
+    {
+        mPlaceholderSize = size;
+        mSettings->setValue(CFG_KEY_LAZY_SIZE, size);
+    }
+
+    if (isSeparate() != mSettings->value(CFG_KEY_LAZY_SEPARATE, false).toBool())
+        mSettings->setValue(CFG_KEY_LAZY_SEPARATE, isSeparate());
+
+    if (isExpandable() != mSettings->value(CFG_KEY_LAZY_EXPANDABLE, false).toBool())
+        mSettings->setValue(CFG_KEY_LAZY_EXPANDABLE, isExpandable());
 }
 
 
@@ -362,6 +604,9 @@ void Plugin::realign()
  ************************************************/
 void Plugin::showConfigureDialog()
 {
+    if (!mPlugin)
+        return;
+
     // store a pointer to each plugin using the plugins' names
     static QHash<QString, QPointer<QDialog> > refs;
     QDialog *dialog = refs[name()].data();
@@ -34,6 +34,7 @@
 #include <LXQt/PluginInfo>
 #include "ilxqtpanel.h"
 #include "lxqtpanelglobals.h"
+#include "pluginlibraryloader.h"
 
 class QPluginLoader;
 class QSettings;
@@ -41,6 +42,7 @@ class ILxQtPanelPlugin;
 class ILxQtPanelPluginLibrary;
 class LxQtPanel;
 class QMenu;
+class SettingsModel;
 
 
 class LXQT_PANEL_API Plugin : public QFrame
@@ -55,10 +57,13 @@ public:
     };
 
 
-    explicit Plugin(const LxQt::PluginInfo &desktopFile, const QString &settingsFile, const QString &settingsGroup, LxQtPanel *panel);
+    explicit Plugin(const LxQt::PluginInfo &desktopFile, SettingsModel *settingsModel, const QString &settingsGroup, LxQtPanel *panel);
     ~Plugin();
 
-    bool isLoaded() const { return mPlugin != 0; }
+    bool isLoaded() const { return mPlugin != 0 || mPlaceholder; }
+    bool isPlaceholder() const { return mPlaceholder; }
+    // The plugin without a visible widget has nothing to paint.
+    bool isPainted() const { return mPainted || !mPluginWidget || !mPluginWidget->isVisible(); }
     Alignment alignment() const { return mAlignment; }
     void setAlignment(Alignment alignment);
 
@@ -75,31 +80,45 @@ public:
     bool isExpandable() const;
 
     QWidget *widget() { return mPluginWidget; }
+    bool hasNativeWindows() const;
 
     QString name() const { return mName; }
 
+    QSize sizeHint() const;
+
+    void updateIconSize();
+    void setPanelHidden(bool hidden);
+    void saveLazyHints();
+
     // For QSS properties ..................
     static QColor moveMarkerColor() { return mMoveMarkerColor; }
     static void setMoveMarkerColor(QColor color) { mMoveMarkerColor = color; }
 
 public slots:
     void realign();
+    void loadDeferred();
 
 signals:
     void startMove();
     void remove();
+    void loaded();
+    void painted();
 
 protected:
     void contextMenuEvent(QContextMenuEvent *event);
     void mousePressEvent(QMouseEvent *event);
     void mouseDoubleClickEvent(QMouseEvent *event);
     void showEvent(QShowEvent *event);
+    void enterEvent(QEvent *event);
+    void paintEvent(QPaintEvent *event);
+    bool eventFilter(QObject *watched, QEvent *event);
 
 private:
-    bool loadLib(const QString &libraryName);
+    bool load();
+    bool loadLib(const PluginLibraryLoader::Result &lib);
+    void applyIconSize(QObject *object) const;
 
     const LxQt::PluginInfo mDesktopFile;
-    QByteArray calcSettingsHash();
     QPluginLoader *mPluginLoader;
     ILxQtPanelPlugin *mPlugin;
     QWidget *mPluginWidget;
@@ -107,12 +126,22 @@ private:
     QSettings *mSettings;
     QString mSettingsGroup;
     LxQtPanel *mPanel;
-    QByteArray mSettingsHash;
     static QColor mMoveMarkerColor;
     QString mName;
+    PluginLibraryLoader::Result mLibrary;
+
+    // Lazy loading
+    bool mLazy;
+    bool mPlaceholder;
+    QSize mPlaceholderSize;
+    bool mSeparate;
+    bool mExpandable;
+
+    bool mPainted;
+    qint64 mLoadedAt;
 
 private slots:
-    void settingsChanged();
+    void settingsChanged(const QString &group);
     void showConfigureDialog();
     void requestRemove();
 
@@ -0,0 +1,239 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#include "plugindescriptorindex.h"
+#include "startuptrace.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <XdgDirs>
+
+#define PLUGIN_SERVICE_TYPE "LxQtPanel/Plugin"
+#define CACHE_VERSION       1
+
+/************************************************
+
+ ************************************************/
+static QStringList pluginDesktopDirs()
+{
+    QStringList dirs;
+    dirs << QString(getenv("LXQT_PANEL_PLUGINS_DIR")).split(':', QString::SkipEmptyParts);
+    dirs << QString("%1/%2").arg(XdgDirs::dataHome(), "/lxqt/lxqt-panel");
+    dirs << PLUGIN_DESKTOPS_DIR;
+    return dirs;
+}
+
+
+/************************************************
+
+ ************************************************/
+PluginDescriptorIndex *PluginDescriptorIndex::instance()
+{
+    static PluginDescriptorIndex index;
+    return &index;
+}
+
+
+/************************************************
+
+ ************************************************/
+PluginDescriptorIndex::PluginDescriptorIndex():
+    mDesktopDirs(pluginDesktopDirs()),
+    mBuilt(false),
+    mScanCount(0),
+    mLookupCount(0),
+    mParseCount(0),
+    mElapsed(0),
+    mFromDiskCache(false)
+{
+    mCacheFile = QString("%1/lxqt-panel/plugins.cache").arg(XdgDirs::cacheHome());
+}
+
+
+/************************************************
+
+ ************************************************/
+LxQt::PluginInfo PluginDescriptorIndex::find(const QString &id)
+{
+    TraceSpan span("descriptor search", id);
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!mBuilt)
+        build();
+
+    mLookupCount++;
+
+    LxQt::PluginInfo info = mInfos.value(id);
+    if (!info.isValid() && mFiles.contains(id))
+    {
+        mParseCount++;
+        if (!info.load(mFiles.value(id)) && mFromDiskCache)
+        {
+            // The file is gone since the cache was written, rescan and try again.
+            scan();
+            saveCache();
+            info = mInfos.value(id);
+        }
+        else
+        {
+            mInfos.insert(id, info);
+        }
+    }
+
+    mElapsed += timer.elapsed();
+    return info;
+}
+
+
+/************************************************
+
+ ************************************************/
+void PluginDescriptorIndex::build()
+{
+    mBuilt = true;
+    if (loadCache())
+        return;
+
+    scan();
+    saveCache();
+}
+
+
+/************************************************
+ The only place where the plugin directories are walked.
+ ************************************************/
+void PluginDescriptorIndex::scan()
+{
+    TraceSpan span("descriptor scan");
+    mScanCount++;
+    mFromDiskCache = false;
+    mFiles.clear();
+    mInfos.clear();
+
+    LxQt::PluginInfoList list = LxQt::PluginInfo::search(mDesktopDirs, PLUGIN_SERVICE_TYPE, "*");
+    foreach (const LxQt::PluginInfo &info, list)
+    {
+        mParseCount++;
+        if (mFiles.contains(info.id()))
+            continue;
+
+        mFiles.insert(info.id(), info.fileName());
+        mInfos.insert(info.id(), info);
+    }
+}
+
+
+/************************************************
+
+ ************************************************/
+QList<qint64> PluginDescriptorIndex::dirsTimeStamps() const
+{
+    QList<qint64> res;
+    foreach (const QString &dir, mDesktopDirs)
+    {
+        QFileInfo fi(dir);
+        res << (fi.exists() ? fi.lastModified().toMSecsSinceEpoch() : 0);
+    }
+    return res;
+}
+
+
+/************************************************
+
+ ************************************************/
+bool PluginDescriptorIndex::loadCache()
+{
+    if (!QFileInfo(mCacheFile).exists())
+        return false;
+
+    QSettings cache(mCacheFile, QSettings::IniFormat);
+    if (cache.value("version").toInt() != CACHE_VERSION)
+        return false;
+
+    QList<qint64> stamps = dirsTimeStamps();
+    int count = cache.beginReadArray("dirs");
+    bool valid = (count == mDesktopDirs.count());
+    for (int i = 0; valid && i < count; ++i)
+    {
+        cache.setArrayIndex(i);
+        valid = cache.value("path").toString() == mDesktopDirs.at(i) &&
+                cache.value("mtime").toLongLong() == stamps.at(i);
+    }
+    cache.endArray();
+
+    if (!valid)
+        return false;
+
+    mFiles.clear();
+    mInfos.clear();
+    count = cache.beginReadArray("plugins");
+    for (int i = 0; i < count; ++i)
+    {
+        cache.setArrayIndex(i);
+        mFiles.insert(cache.value("id").toString(), cache.value("file").toString());
+    }
+    cache.endArray();
+
+    mFromDiskCache = true;
+    return true;
+}
+
+
+/************************************************
+
+ ************************************************/
+void PluginDescriptorIndex::saveCache() const
+{
+    QDir().mkpath(QFileInfo(mCacheFile).absolutePath());
+    QSettings cache(mCacheFile, QSettings::IniFormat);
+    cache.clear();
+    cache.setValue("version", CACHE_VERSION);
+
+    QList<qint64> stamps = dirsTimeStamps();
+    cache.beginWriteArray("dirs", mDesktopDirs.count());
+    for (int i = 0; i < mDesktopDirs.count(); ++i)
+    {
+        cache.setArrayIndex(i);
+        cache.setValue("path", mDesktopDirs.at(i));
+        cache.setValue("mtime", stamps.at(i));
+    }
+    cache.endArray();
+
+    cache.beginWriteArray("plugins", mFiles.count());
+    int i = 0;
+    QHashIterator<QString, QString> it(mFiles);
+    while (it.hasNext())
+    {
+        it.next();
+        cache.setArrayIndex(i++);
+        cache.setValue("id", it.key());
+        cache.setValue("file", it.value());
+    }
+    cache.endArray();
+}
@@ -0,0 +1,89 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#ifndef PLUGINDESCRIPTORINDEX_H
+#define PLUGINDESCRIPTORINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <LXQt/PluginInfo>
+#include "lxqtpanelglobals.h"
+
+/*! \brief The PluginDescriptorIndex class keeps the list of the available
+    panel plugins (their .desktop files).
+
+    The index is built once per process and shared by all the panels, so
+    loading the plugins doesn't walk the plugin directories again and again.
+    The list of the found files is stored in the user cache directory together
+    with modification times of the scanned directories. While the directories
+    are not changed, the next start doesn't scan them at all, only the
+    .desktop files of the really used plugins are parsed.
+ */
+class LXQT_PANEL_API PluginDescriptorIndex
+{
+public:
+    static PluginDescriptorIndex *instance();
+
+    QStringList desktopDirs() const { return mDesktopDirs; }
+
+    /*! Returns the description of the plugin with the given id.
+        If the plugin is not found, returns an invalid PluginInfo.
+     */
+    LxQt::PluginInfo find(const QString &id);
+
+    // Statistics .........................
+    int scanCount() const { return mScanCount; }
+    int lookupCount() const { return mLookupCount; }
+    int parseCount() const { return mParseCount; }
+    qint64 elapsed() const { return mElapsed; }
+    bool fromDiskCache() const { return mFromDiskCache; }
+
+private:
+    PluginDescriptorIndex();
+
+    QStringList mDesktopDirs;
+    QString mCacheFile;
+    bool mBuilt;
+
+    // Plugin id -> .desktop file
+    QHash<QString, QString> mFiles;
+    QHash<QString, LxQt::PluginInfo> mInfos;
+
+    int mScanCount;
+    int mLookupCount;
+    int mParseCount;
+    qint64 mElapsed;
+    bool mFromDiskCache;
+
+    void build();
+    void scan();
+    bool loadCache();
+    void saveCache() const;
+    QList<qint64> dirsTimeStamps() const;
+};
+
+#endif // PLUGINDESCRIPTORINDEX_H
@@ -0,0 +1,155 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#include "pluginlibraryloader.h"
+#include "startuptrace.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QDir>
+#include <QFileInfo>
+#include <QPluginLoader>
+#include <QProcessEnvironment>
+#include <QElapsedTimer>
+#include <QtConcurrentRun>
+
+/************************************************
+ Runs in the worker thread.
+ ************************************************/
+static PluginLibraryLoader::Result loadLibrary(const QString &pluginId)
+{
+    PluginLibraryLoader::Result res;
+    QElapsedTimer timer;
+    timer.start();
+
+    QString baseName = PluginLibraryLoader::libraryFileName(pluginId);
+    foreach(QString dirName, PluginLibraryLoader::libraryDirs())
+    {
+        QFileInfo fi(QDir(dirName), baseName);
+        if (!fi.exists())
+            continue;
+
+        res.found = true;
+        res.resolveTime += timer.restart();
+
+        QPluginLoader *loader = new QPluginLoader(fi.absoluteFilePath());
+        bool loaded;
+        {
+            TraceSpan span("QPluginLoader::load", pluginId);
+            loaded = loader->load();
+        }
+        res.loadTime += timer.restart();
+
+        if (loaded)
+        {
+            // The loader is used and deleted by the Plugin in the GUI thread.
+            if (loader->thread() != qApp->thread())
+                loader->moveToThread(qApp->thread());
+
+            res.loader = loader;
+            return res;
+        }
+
+        res.error = loader->errorString();
+        delete loader;
+    }
+
+    res.resolveTime += timer.elapsed();
+    return res;
+}
+
+
+/************************************************
+
+ ************************************************/
+PluginLibraryLoader *PluginLibraryLoader::instance()
+{
+    static PluginLibraryLoader loader;
+    return &loader;
+}
+
+
+/************************************************
+ The libraries that no plugin has taken, e.g. the plugin
+ was removed from the config before it was built.
+ ************************************************/
+PluginLibraryLoader::~PluginLibraryLoader()
+{
+    foreach (QFuture<Result> job, mJobs)
+        delete job.result().loader;
+}
+
+
+/************************************************
+
+ ************************************************/
+QStringList PluginLibraryLoader::libraryDirs()
+{
+    QStringList dirs;
+    dirs << QProcessEnvironment::systemEnvironment().value("LXQTPANEL_PLUGIN_PATH").split(":");
+    dirs << PLUGIN_DIR;
+    return dirs;
+}
+
+
+/************************************************
+
+ ************************************************/
+QString PluginLibraryLoader::libraryFileName(const QString &pluginId)
+{
+    return QString("lib%1.so").arg(pluginId);
+}
+
+
+/************************************************
+
+ ************************************************/
+void PluginLibraryLoader::preload(const QStringList &pluginIds)
+{
+    foreach (const QString &id, pluginIds)
+    {
+        if (!id.isEmpty() && !mJobs.contains(id))
+            mJobs.insert(id, QtConcurrent::run(loadLibrary, id));
+    }
+}
+
+
+/************************************************
+
+ ************************************************/
+PluginLibraryLoader::Result PluginLibraryLoader::take(const QString &pluginId)
+{
+    // The next plugin of the same type loads the already loaded
+    // library synchronously, it costs nothing.
+    if (!mJobs.contains(pluginId))
+        return loadLibrary(pluginId);
+
+    QFuture<Result> job = mJobs.take(pluginId);
+    QElapsedTimer timer;
+    timer.start();
+    Result res = job.result();
+    res.waitTime = timer.elapsed();
+    return res;
+}
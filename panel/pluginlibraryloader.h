@@ -0,0 +1,81 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#ifndef PLUGINLIBRARYLOADER_H
+#define PLUGINLIBRARYLOADER_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QFuture>
+#include "lxqtpanelglobals.h"
+
+class QPluginLoader;
+
+/*! \brief The PluginLibraryLoader class loads the plugin libraries in the
+    worker threads.
+
+    The lxqt-panel calls preload() for all plugins of all panels before the first
+    panel is created. The libraries are searched for and dlopen'ed in parallel,
+    while the GUI thread builds the plugins one by one in the configured order.
+    The plugin objects and widgets are always created in the GUI thread, only
+    the QPluginLoader::load() is moved out of it.
+ */
+class LXQT_PANEL_API PluginLibraryLoader
+{
+public:
+    struct Result
+    {
+        Result(): loader(0), found(false), resolveTime(0), loadTime(0), waitTime(0) {}
+        QPluginLoader *loader;
+        bool found;
+        QString error;
+        qint64 resolveTime;
+        qint64 loadTime;
+        qint64 waitTime;
+    };
+
+    static PluginLibraryLoader *instance();
+
+    static QStringList libraryDirs();
+    static QString libraryFileName(const QString &pluginId);
+
+    void preload(const QStringList &pluginIds);
+
+    /*! Returns the loaded library for the plugin. If the library was not
+        preloaded or it's already taken by another plugin, it's loaded
+        synchronously. The caller takes ownership of the loader.
+     */
+    Result take(const QString &pluginId);
+
+private:
+    PluginLibraryLoader() {}
+    ~PluginLibraryLoader();
+
+    QHash<QString, QFuture<Result> > mJobs;
+};
+
+#endif // PLUGINLIBRARYLOADER_H
@@ -30,6 +30,31 @@
 #include "plugin.h"
 #include "lxqtpanellayout.h"
 #include <QMouseEvent>
+#include <QPainter>
+
+
+/************************************************
+ The insert marker. It's a plain widget over the
+ plugins, moving it repaints only the old and the
+ new marker rects.
+ ************************************************/
+class MoveMarker: public QWidget
+{
+public:
+    explicit MoveMarker(QWidget *parent):
+        QWidget(parent)
+    {
+        setAttribute(Qt::WA_TransparentForMouseEvents);
+        setAttribute(Qt::WA_NoSystemBackground);
+    }
+
+protected:
+    void paintEvent(QPaintEvent *)
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), Plugin::moveMarkerColor());
+    }
+};
 
 
 /************************************************
@@ -38,7 +63,10 @@
 PluginMoveProcessor::PluginMoveProcessor(LxQtPanelLayout *layout, Plugin *plugin):
     QWidget(plugin),
     mLayout(layout),
-    mPlugin(plugin)
+    mPlugin(plugin),
+    mLastIndex(-1),
+    mLastAfter(false),
+    mMarker(0)
 {
     mDestIndex = mLayout->indexOf(plugin);
 
@@ -51,6 +79,26 @@ PluginMoveProcessor::PluginMoveProcessor(LxQtPanelLayout *layout, Plugin *plugin
  ************************************************/
 PluginMoveProcessor::~PluginMoveProcessor()
 {
+    delete mMarker;
+}
+
+
+/************************************************
+ The layout items are read once when the drag starts.
+ With several lines and the two alignment groups the
+ rects aren't sorted, so they are scanned in a row.
+ ************************************************/
+void PluginMoveProcessor::cacheItems()
+{
+    int count = mLayout->count();
+    mItemRects.resize(count);
+    mItemSeparate.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        QLayoutItem *item = mLayout->itemAt(i);
+        mItemRects[i] = item->geometry();
+        mItemSeparate[i] = LxQtPanelLayout::itemIsSeparate(item);
+    }
 }
 
 
@@ -77,6 +125,7 @@ void PluginMoveProcessor::start()
  ************************************************/
 void PluginMoveProcessor::doStart()
 {
+    cacheItems();
     setMouseTracking(true);
     show(); //  Only visible widgets can grab mouse input.
     grabMouse(mLayout->isHorizontal() ? Qt::SizeHorCursor : Qt::SizeVerCursor);
@@ -92,6 +141,13 @@ void PluginMoveProcessor::mouseMoveEvent(QMouseEvent *event)
 
     MousePosInfo pos = itemByMousePos(mouse);
 
+    // The mouse moves much more often than the marker.
+    if (pos.index == mLastIndex && pos.after == mLastAfter)
+        return;
+
+    mLastIndex = pos.index;
+    mLastAfter = pos.after;
+
     QLayoutItem *prevItem = 0;
     QLayoutItem *nextItem = 0;
     if (pos.after)
@@ -166,25 +222,24 @@ PluginMoveProcessor::MousePosInfo PluginMoveProcessor::itemByMousePos(const QPoi
 {
     MousePosInfo ret;
 
-    for (int i = mLayout->count()-1; i > -1; --i)
+    for (int i = mItemRects.count()-1; i > -1; --i)
     {
-        QLayoutItem *item = mLayout->itemAt(i);
-        QRect itemRect = item->geometry();
+        const QRect &itemRect = mItemRects.at(i);
         if (mouse.x() > itemRect.left() &&
             mouse.y() > itemRect.top())
         {
 
             ret.index = i;
-            ret.item = item;
+            ret.item = mLayout->itemAt(i);
             if (mLayout->isHorizontal())
             {
-                ret.after = LxQtPanelLayout::itemIsSeparate(item) ?
+                ret.after = mItemSeparate.at(i) ?
                         mouse.x() > itemRect.center().x() :
                         mouse.y() > itemRect.center().y() ;
             }
             else
             {
-                ret.after = LxQtPanelLayout::itemIsSeparate(item) ?
+                ret.after = mItemSeparate.at(i) ?
                         mouse.y() > itemRect.center().y() :
                         mouse.x() > itemRect.center().x() ;
             }
@@ -204,55 +259,40 @@ PluginMoveProcessor::MousePosInfo PluginMoveProcessor::itemByMousePos(const QPoi
  ************************************************/
 void PluginMoveProcessor::drawMark(QLayoutItem *item, MarkType markType)
 {
-    QWidget *widget = (item) ? item->widget() : 0;
-
-    static QWidget *prevWidget = 0;
-    if (prevWidget && prevWidget != widget)
-        prevWidget->setStyleSheet("");
-
-    prevWidget = widget;
-
-    if (!widget)
+    if (!item || !item->widget())
+    {
+        if (mMarker)
+            mMarker->hide();
         return;
+    }
+
+    if (!mMarker)
+        mMarker = new MoveMarker(mLayout->parentWidget());
 
-    QString border1;
-    QString border2;
+    const QRect r = item->geometry();
+    QRect mark;
     switch(markType)
     {
     case TopMark:
-        border1 = "top";
-        border2 = "bottom";
+        mark = QRect(r.left(), r.top(), r.width(), 2);
         break;
 
     case BottomMark:
-        border1 = "bottom";
-        border2 = "top";
+        mark = QRect(r.left(), r.bottom() - 1, r.width(), 2);
         break;
 
     case LeftMark:
-        border1 = "left";
-        border2 = "right";
+        mark = QRect(r.left(), r.top(), 2, r.height());
         break;
 
     case RightMark:
-        border1 = "right";
-        border2 = "left";
+        mark = QRect(r.right() - 1, r.top(), 2, r.height());
         break;
-
     }
 
-    widget->setStyleSheet(QString("#%1 {"
-                                  "border-%2: 2px solid rgba(%4, %5, %6, %7); "
-                                  "border-%3: -2px solid; "
-                                  "background-color: transparent; }")
-                          .arg(widget->objectName())
-                          .arg(border1)
-                          .arg(border2)
-                          .arg(Plugin::moveMarkerColor().red())
-                          .arg(Plugin::moveMarkerColor().green())
-                          .arg(Plugin::moveMarkerColor().blue())
-                          .arg(Plugin::moveMarkerColor().alpha())
-                          );
+    mMarker->setGeometry(mark);
+    mMarker->raise();
+    mMarker->show();
 }
 
 
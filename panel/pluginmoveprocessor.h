@@ -32,11 +32,13 @@
 #include <QWidget>
 #include <QVariantAnimation>
 #include <QEvent>
+#include <QVector>
 #include "plugin.h"
 #include "lxqtpanelglobals.h"
 
 class LxQtPanelLayout;
 class QLayoutItem;
+class MoveMarker;
 
 
 class LXQT_PANEL_API PluginMoveProcessor : public QWidget
@@ -84,6 +86,15 @@ private:
     Plugin *mPlugin;
     int mDestIndex;
 
+    // The geometries of the layout items, scanned by itemByMousePos().
+    // The items don't move while dragging.
+    QVector<QRect> mItemRects;
+    QVector<bool> mItemSeparate;
+    int mLastIndex;
+    bool mLastAfter;
+    MoveMarker *mMarker;
+
+    void cacheItems();
     MousePosInfo itemByMousePos(const QPoint mouse) const;
     void drawMark(QLayoutItem *item, MarkType markType);
 };
@@ -0,0 +1,192 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#include "settingsmodel.h"
+#include "lxqtpanellimits.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QStringList>
+#include <LXQt/Settings>
+
+/************************************************
+
+ ************************************************/
+SettingsModel::SettingsModel(const QString &configFile, QObject *parent):
+    QObject(parent),
+    mFlushCount(0)
+{
+    if (configFile.isEmpty())
+        mSettings = new LxQt::Settings("panel", this);
+    else
+        mSettings = new LxQt::Settings(configFile, QSettings::IniFormat, this);
+
+    connect(mSettings, SIGNAL(settingsChanged()), this, SLOT(fileChanged()));
+    mSettings->installEventFilter(this);
+
+    mFlushTimer.setSingleShot(true);
+    mFlushTimer.setInterval(SETTINGS_SAVE_DELAY);
+    connect(&mFlushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    connect(qApp, SIGNAL(aboutToQuit()), this, SLOT(flush()));
+}
+
+
+/************************************************
+
+ ************************************************/
+QString SettingsModel::fileName() const
+{
+    return mSettings->fileName();
+}
+
+
+/************************************************
+
+ ************************************************/
+QSettings *SettingsModel::groupView(const QString &group, QObject *parent)
+{
+    // QSettings objects on the same file share the parsed data,
+    // the new object doesn't read the file again.
+    QSettings *view = new QSettings(fileName(), QSettings::IniFormat, parent);
+    view->beginGroup(group);
+
+    mViews.insert(view, group);
+    if (!mGroupHashes.contains(group))
+        mGroupHashes.insert(group, calcGroupHash(group));
+
+    connect(view, SIGNAL(destroyed(QObject*)), this, SLOT(viewDestroyed(QObject*)));
+    view->installEventFilter(this);
+    return view;
+}
+
+
+/************************************************
+
+ ************************************************/
+void SettingsModel::viewDestroyed(QObject *view)
+{
+    // QSettings flushes itself in the destructor.
+    mDirty.remove(static_cast<QSettings*>(view));
+
+    QString group = mViews.take(view);
+    if (!mViews.values().contains(group))
+        mGroupHashes.remove(group);
+}
+
+
+/************************************************
+ LxQt::Settings has already re-read the file.
+ ************************************************/
+void SettingsModel::fileChanged()
+{
+    checkGroups(mGroupHashes.keys());
+}
+
+
+/************************************************
+
+ ************************************************/
+void SettingsModel::checkGroups(const QStringList &groups)
+{
+    QStringList changed;
+    foreach (const QString &group, groups)
+    {
+        QByteArray hash = calcGroupHash(group);
+        if (hash != mGroupHashes.value(group))
+        {
+            mGroupHashes.insert(group, hash);
+            changed << group;
+        }
+    }
+
+    foreach (const QString &group, changed)
+        emit groupChanged(group);
+}
+
+
+/************************************************
+ QSettings posts the UpdateRequest to itself after the first
+ change and writes the file when it gets the event. We catch
+ the event, the file is written later by flush().
+ ************************************************/
+bool SettingsModel::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() != QEvent::UpdateRequest)
+        return QObject::eventFilter(watched, event);
+
+    mDirty << static_cast<QSettings*>(watched);
+    if (!mFlushTimer.isActive())
+        mFlushTimer.start();
+
+    // The data is shared, the plugins see the first change before the file is written.
+    // QSettings doesn't post the event again until it's synced, flush() checks the rest.
+    if (watched == mSettings)
+        checkGroups(mGroupHashes.keys());
+    else if (mViews.contains(watched))
+        checkGroups(QStringList() << mViews.value(watched));
+
+    return true;
+}
+
+
+/************************************************
+
+ ************************************************/
+void SettingsModel::flush()
+{
+    mFlushTimer.stop();
+    if (mDirty.isEmpty())
+        return;
+
+    // The first sync() writes the changes of all the objects, the
+    // next ones only reset the pending flags of their objects.
+    mSettings->sync();
+    foreach (QSettings *settings, mDirty)
+        settings->sync();
+
+    mDirty.clear();
+    mFlushCount++;
+
+    checkGroups(mGroupHashes.keys());
+}
+
+
+/************************************************
+
+ ************************************************/
+QByteArray SettingsModel::calcGroupHash(const QString &group)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+
+    mSettings->beginGroup(group);
+    QStringList keys = mSettings->allKeys();
+    foreach (const QString &key, keys)
+        stream << key << mSettings->value(key);
+    mSettings->endGroup();
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Md5);
+}
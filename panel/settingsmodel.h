@@ -0,0 +1,100 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#ifndef SETTINGSMODEL_H
+#define SETTINGSMODEL_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include "lxqtpanelglobals.h"
+
+class QSettings;
+namespace LxQt {
+class Settings;
+}
+
+/*! \brief The SettingsModel class is the single owner of the panel
+    configuration file.
+
+    Only the SettingsModel watches the file, so an external change of the file is
+    read once for all panels and plugins. Every plugin gets its own view (see
+    groupView()), the QSettings object working on the same file and positioned on
+    the plugin group. All the views share the data parsed by the model.
+
+    After the file is changed, the model compares the groups that have views and
+    emits groupChanged() only for the changed ones.
+
+    The model also works as a write-behind cache. The changes made through the
+    model settings() or any view are kept in memory and written to the disk once,
+    SETTINGS_SAVE_DELAY after the first change or when the application quits.
+    QSettings writes the file through QSaveFile, so the file is replaced
+    atomically.
+ */
+class LXQT_PANEL_API SettingsModel : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SettingsModel(const QString &configFile, QObject *parent = 0);
+
+    LxQt::Settings *settings() const { return mSettings; }
+    QString fileName() const;
+
+    /*! Returns the new QSettings object for the group. The caller takes the ownership.
+     */
+    QSettings *groupView(const QString &group, QObject *parent);
+
+    int flushCount() const { return mFlushCount; }
+
+public slots:
+    void flush();
+
+signals:
+    void groupChanged(const QString &group);
+
+private slots:
+    void fileChanged();
+    void viewDestroyed(QObject *view);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event);
+
+private:
+    LxQt::Settings *mSettings;
+    QTimer mFlushTimer;
+    QSet<QSettings*> mDirty;
+    int mFlushCount;
+    QHash<QObject*, QString> mViews;
+    QHash<QString, QByteArray> mGroupHashes;
+
+    QByteArray calcGroupHash(const QString &group);
+    void checkGroups(const QStringList &groups);
+};
+
+#endif // SETTINGSMODEL_H
@@ -0,0 +1,268 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "stallwatchdog.h"
+#include "plugin.h"
+#include <QAbstractEventDispatcher>
+#include <QCoreApplication>
+#include <QDebug>
+#include <csignal>
+#include <execinfo.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// The GUI thread prints its stack on this signal.
+#define STALL_STACK_SIGNAL SIGUSR2
+#define STALL_STACK_DEPTH 64
+
+StallWatchdog *StallWatchdog::mInstance = 0;
+
+/************************************************
+
+ ************************************************/
+void StallWatchdog::init()
+{
+    if (mInstance)
+        return;
+
+    bool ok;
+    int threshold = qgetenv("LXQT_PANEL_STALL").toInt(&ok);
+    if (!ok || threshold <= 0)
+        return;
+
+    mInstance = new StallWatchdog(threshold);
+    mInstance->start();
+    qDebug() << "StallWatchdog: reporting the stalls longer than" << threshold << "ms";
+}
+
+
+/************************************************
+
+ ************************************************/
+StallWatchdog::StallWatchdog(int threshold):
+    QThread(),
+    mThreshold(threshold),
+    mGuiThread(QThread::currentThreadId()),
+    mDepth(0),
+    mBusySince(0),
+    mBusyCount(0),
+    mPlugin(-1),
+    mEventType(QEvent::None),
+    mClassName(0),
+    mStop(0)
+{
+    mClock.start();
+
+    // The dispatcher doesn't tell us when it's busy. aboutToBlock() ends the
+    // busy time when a nested event loop waits, awake() starts it again.
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance();
+    connect(dispatcher, SIGNAL(aboutToBlock()), this, SLOT(aboutToBlock()), Qt::DirectConnection);
+    connect(dispatcher, SIGNAL(awake()), this, SLOT(awake()), Qt::DirectConnection);
+    connect(qApp, SIGNAL(aboutToQuit()), this, SLOT(stop()));
+
+    // The first call of backtrace() loads libgcc, it must not be done in the signal handler.
+    void *frames[STALL_STACK_DEPTH];
+    backtrace(frames, STALL_STACK_DEPTH);
+
+    struct sigaction sa;
+    sa.sa_handler = stackSignalHandler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(STALL_STACK_SIGNAL, &sa, 0);
+}
+
+
+/************************************************
+
+ ************************************************/
+void StallWatchdog::stackSignalHandler(int)
+{
+    void *frames[STALL_STACK_DEPTH];
+    int count = backtrace(frames, STALL_STACK_DEPTH);
+    backtrace_symbols_fd(frames, count, STDERR_FILENO);
+}
+
+
+/************************************************
+
+ ************************************************/
+StallWatchdog::Context StallWatchdog::enter(Plugin *plugin, QObject *receiver, QEvent::Type type)
+{
+    // The outermost dispatch, or the first one after a nested event loop
+    // waited, starts the busy time.
+    mDepth++;
+    beginBusy();
+
+    Context previous;
+    previous.plugin = mPlugin.load();
+    previous.eventType = mEventType.load();
+    previous.className = mClassName.load();
+
+    int id = -1;
+    if (plugin)
+    {
+        QString group = plugin->settingsGroup();
+        id = mPluginIds.value(group, -1);
+        if (id < 0)
+        {
+            QMutexLocker locker(&mNamesMutex);
+            id = mPluginNames.count();
+            mPluginNames << group;
+            mPluginIds.insert(group, id);
+        }
+    }
+
+    mPlugin.store(id);
+    mEventType.store(type);
+    mClassName.store(receiver->metaObject()->className());
+    return previous;
+}
+
+
+/************************************************
+
+ ************************************************/
+void StallWatchdog::leave(const Context &previous)
+{
+    mPlugin.store(previous.plugin);
+    mEventType.store(previous.eventType);
+    mClassName.store(previous.className);
+
+    if (--mDepth == 0)
+        endBusy();
+}
+
+
+/************************************************
+
+ ************************************************/
+void StallWatchdog::aboutToBlock()
+{
+    if (mDepth > 0)
+        endBusy();
+}
+
+
+/************************************************
+
+ ************************************************/
+void StallWatchdog::awake()
+{
+    if (mDepth > 0)
+        beginBusy();
+}
+
+
+/************************************************
+
+ ************************************************/
+void StallWatchdog::beginBusy()
+{
+    // 0 means idle, so the time is counted from 1.
+    if (mBusySince.load())
+        return;
+
+    mBusySince.store(mClock.elapsed() + 1);
+    mBusyCount.ref();
+}
+
+
+/************************************************
+
+ ************************************************/
+void StallWatchdog::endBusy()
+{
+    qint64 since = mBusySince.load();
+    mBusySince.store(0);
+    if (!since)
+        return;
+
+    qint64 duration = mClock.elapsed() + 1 - since;
+    if (duration >= mThreshold)
+        qWarning() << "StallWatchdog: the panel was not responding for" << duration << "ms";
+}
+
+
+/************************************************
+
+ ************************************************/
+void StallWatchdog::stop()
+{
+    mStop.store(1);
+    wait();
+}
+
+
+/************************************************
+ The watchdog thread.
+ ************************************************/
+void StallWatchdog::run()
+{
+    int reported = mBusyCount.load() - 1;
+    unsigned long interval = qMax(10, mThreshold / 4);
+
+    while (!mStop.load())
+    {
+        msleep(interval);
+
+        qint64 since = mBusySince.load();
+        if (!since)
+            continue;
+
+        int busyCount = mBusyCount.load();
+        qint64 duration = mClock.elapsed() + 1 - since;
+        // Once for every stall.
+        if (duration >= mThreshold && busyCount != reported)
+        {
+            reported = busyCount;
+            report(duration);
+        }
+    }
+}
+
+
+/************************************************
+ Called in the watchdog thread. The GUI thread is
+ stuck in the tagged dispatch, so the tags are stable.
+ ************************************************/
+void StallWatchdog::report(qint64 duration)
+{
+    int plugin = mPlugin.load();
+    const char *className = mClassName.load();
+
+    QString pluginName = "lxqt-panel";
+    if (plugin >= 0)
+    {
+        QMutexLocker locker(&mNamesMutex);
+        pluginName = mPluginNames.value(plugin);
+    }
+
+    qWarning() << "StallWatchdog: the panel is not responding for" << duration << "ms in" << pluginName
+               << "while dispatching the event" << mEventType.load()
+               << "to" << (className ? className : "an object");
+
+    // The handler runs in the GUI thread and prints where it is stuck.
+    pthread_kill(reinterpret_cast<pthread_t>(mGuiThread), STALL_STACK_SIGNAL);
+}
@@ -0,0 +1,114 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include "lxqtpanelglobals.h"
+
+class Plugin;
+
+/*! \brief The StallWatchdog class reports when the GUI thread doesn't return
+    to the event loop for too long.
+
+    Set the LXQT_PANEL_STALL environment variable to the threshold in ms, and a
+    watchdog thread checks the GUI thread. The GUI thread is busy from the
+    outermost enter() to the matching leave(). A nested event loop (a menu, a
+    dialog) started by the event is idle while it waits for events: the busy
+    time ends on its aboutToBlock() and starts again on its awake() or the
+    next enter(). When the GUI thread is busy longer than the threshold, the
+    watchdog prints the plugin (its settings group), the receiver class and
+    the event type being dispatched, and the stack of the GUI thread.
+
+    LxQtPanelApplication::notify() tags every event dispatch with enter() and
+    leave().
+
+    When the variable is not set, instance() returns 0 and nothing is done.
+ */
+class LXQT_PANEL_API StallWatchdog : public QThread
+{
+    Q_OBJECT
+public:
+    static void init();
+    static StallWatchdog *instance() { return mInstance; }
+
+    struct Context
+    {
+        int plugin;
+        int eventType;
+        const char *className;
+    };
+
+    Context enter(Plugin *plugin, QObject *receiver, QEvent::Type type);
+    void leave(const Context &previous);
+
+protected:
+    void run();
+
+private slots:
+    void aboutToBlock();
+    void awake();
+    void stop();
+
+private:
+    StallWatchdog(int threshold);
+
+    static StallWatchdog *mInstance;
+
+    int mThreshold;
+    QElapsedTimer mClock;
+    Qt::HANDLE mGuiThread;
+    // The nesting of enter() calls, only used by the GUI thread.
+    int mDepth;
+
+    // Written by the GUI thread, read by the watchdog.
+    QAtomicInteger<qint64> mBusySince;
+    QAtomicInt mBusyCount;
+    QAtomicInt mPlugin;
+    QAtomicInt mEventType;
+    QAtomicPointer<const char> mClassName;
+    QAtomicInt mStop;
+
+    // The settings groups of the plugins, the index is the plugin id.
+    QHash<QString, int> mPluginIds;
+    QStringList mPluginNames;
+    QMutex mNamesMutex;
+
+    void beginBusy();
+    void endBusy();
+    void report(qint64 duration);
+    static void stackSignalHandler(int);
+};
+
+#endif // STALLWATCHDOG_H
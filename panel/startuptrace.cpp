@@ -0,0 +1,145 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#include "startuptrace.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QHash>
+#include <QVector>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+bool StartupTrace::mEnabled = false;
+
+namespace
+{
+    struct Span
+    {
+        const char *name;
+        QString arg;
+        int thread;
+        qint64 start;
+        qint64 duration;
+    };
+
+    QString traceFile;
+    QElapsedTimer clock;
+    QMutex mutex;
+    QVector<Span> spans;
+    QHash<Qt::HANDLE, int> threads;
+}
+
+
+/************************************************
+
+ ************************************************/
+void StartupTrace::init()
+{
+    traceFile = QString::fromLocal8Bit(qgetenv("LXQT_PANEL_TRACE"));
+    mEnabled = !traceFile.isEmpty();
+    if (mEnabled)
+        clock.start();
+}
+
+
+/************************************************
+
+ ************************************************/
+qint64 StartupTrace::now()
+{
+    return clock.nsecsElapsed() / 1000;
+}
+
+
+/************************************************
+
+ ************************************************/
+void StartupTrace::addSpan(const char *name, const QString &arg, qint64 start, qint64 duration)
+{
+    QMutexLocker locker(&mutex);
+
+    Qt::HANDLE threadId = QThread::currentThreadId();
+    if (!threads.contains(threadId))
+        threads.insert(threadId, threads.count() + 1);
+
+    Span span;
+    span.name = name;
+    span.arg = arg;
+    span.thread = threads.value(threadId);
+    span.start = start;
+    span.duration = duration;
+    spans << span;
+}
+
+
+/************************************************
+
+ ************************************************/
+void StartupTrace::save()
+{
+    if (!mEnabled)
+        return;
+
+    QMutexLocker locker(&mutex);
+
+    QJsonArray events;
+    foreach (const Span &span, spans)
+    {
+        QJsonObject event;
+        event["name"] = QString::fromLatin1(span.name);
+        event["cat"] = QString("lxqt-panel");
+        event["ph"] = QString("X");
+        event["pid"] = QCoreApplication::applicationPid();
+        event["tid"] = span.thread;
+        event["ts"] = span.start;
+        event["dur"] = span.duration;
+        if (!span.arg.isEmpty())
+        {
+            QJsonObject args;
+            args["name"] = span.arg;
+            event["args"] = args;
+        }
+        events.append(event);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = QString("ms");
+
+    QFile file(traceFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "Can't write the trace file" << traceFile << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+}
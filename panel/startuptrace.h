@@ -0,0 +1,89 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QString>
+#include "lxqtpanelglobals.h"
+
+/*! \brief The StartupTrace class records where the panel spends its time.
+
+    Set the LXQT_PANEL_TRACE environment variable to a file name, and the panel
+    writes the recorded spans there in the Chrome trace event format when all
+    panels have started, and again on exit.
+    The file can be opened with chrome://tracing or https://ui.perfetto.dev.
+
+    When the variable is not set, nothing is recorded, TraceSpan only checks
+    the isEnabled() flag.
+ */
+class LXQT_PANEL_API StartupTrace
+{
+public:
+    static void init();
+    static bool isEnabled() { return mEnabled; }
+
+    //! Microseconds since init().
+    static qint64 now();
+
+    static void addSpan(const char *name, const QString &arg, qint64 start, qint64 duration);
+    static void save();
+
+private:
+    static bool mEnabled;
+};
+
+
+/*! \brief The TraceSpan class records the span from its creation to its destruction.
+ */
+class TraceSpan
+{
+public:
+    TraceSpan(const char *name, const QString &arg = QString()):
+        mEnabled(StartupTrace::isEnabled())
+    {
+        if (mEnabled)
+        {
+            mName = name;
+            mArg = arg;
+            mStart = StartupTrace::now();
+        }
+    }
+
+    ~TraceSpan()
+    {
+        if (mEnabled)
+            StartupTrace::addSpan(mName, mArg, mStart, StartupTrace::now() - mStart);
+    }
+
+private:
+    bool mEnabled;
+    const char *mName;
+    QString mArg;
+    qint64 mStart;
+};
+
+#endif // STARTUPTRACE_H
@@ -0,0 +1,333 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "tickservice.h"
+#include "wakeupstats.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QPointer>
+#include <QSocketNotifier>
+#include <QDebug>
+#include <cerrno>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#ifndef TFD_TIMER_CANCEL_ON_SET
+#define TFD_TIMER_CANCEL_ON_SET (1 << 1)
+#endif
+
+// The ticks that are due in this time are fired with the current one.
+#define TICK_SLACK 5
+
+/************************************************
+
+ ************************************************/
+TickSubscription::TickSubscription(QObject *owner, int interval, QObject *receiver):
+    QObject(receiver),
+    mNext(0),
+    mPaused(false),
+    mMissed(false),
+    mOwner(owner),
+    mInterval(qMax(1, interval))
+{
+}
+
+
+/************************************************
+
+ ************************************************/
+TickService *TickService::instance()
+{
+    static TickService service;
+    return &service;
+}
+
+
+/************************************************
+
+ ************************************************/
+TickService::TickService():
+    QObject(),
+    mNotifier(0),
+    mArmedAt(0),
+    mWakeupCount(0)
+{
+    mTimerFd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (mTimerFd >= 0)
+    {
+        // The instance outlives the application, the notifier must not.
+        mNotifier = new QSocketNotifier(mTimerFd, QSocketNotifier::Read, qApp);
+        connect(mNotifier, SIGNAL(activated(int)), this, SLOT(timeout()));
+    }
+    else
+    {
+        qWarning() << "TickService: timerfd is not available, QTimer is used";
+        mTimer.setSingleShot(true);
+        mTimer.setTimerType(Qt::PreciseTimer);
+        connect(&mTimer, SIGNAL(timeout()), this, SLOT(timeout()));
+    }
+}
+
+
+/************************************************
+
+ ************************************************/
+TickService::~TickService()
+{
+    if (mTimerFd >= 0)
+        close(mTimerFd);
+}
+
+
+/************************************************
+
+ ************************************************/
+qint64 TickService::nextTick(qint64 now, int interval)
+{
+    return (now / interval + 1) * interval;
+}
+
+
+/************************************************
+
+ ************************************************/
+void TickService::subscribe(QObject *owner, int interval, QObject *receiver, const char *member)
+{
+    TickSubscription *sub = new TickSubscription(owner, interval, receiver);
+    sub->mNext = nextTick(QDateTime::currentMSecsSinceEpoch(), sub->interval());
+    sub->mPaused = mPausedOwners.contains(owner);
+    connect(sub, SIGNAL(tick()), receiver, member);
+    connect(sub, SIGNAL(destroyed(QObject*)), this, SLOT(subscriptionDestroyed(QObject*)));
+    mSubscriptions << sub;
+    schedule();
+}
+
+
+/************************************************
+
+ ************************************************/
+void TickService::unsubscribe(QObject *owner, QObject *receiver)
+{
+    foreach (TickSubscription *sub, mSubscriptions)
+    {
+        if (sub->owner() == owner && sub->parent() == receiver)
+            delete sub;
+    }
+}
+
+
+/************************************************
+
+ ************************************************/
+void TickService::subscriptionDestroyed(QObject *subscription)
+{
+    mSubscriptions.removeAll(static_cast<TickSubscription*>(subscription));
+    schedule();
+}
+
+
+/************************************************
+
+ ************************************************/
+void TickService::ownerDestroyed(QObject *owner)
+{
+    mPausedOwners.remove(owner);
+}
+
+
+/************************************************
+
+ ************************************************/
+void TickService::setPaused(QObject *owner, bool paused)
+{
+    if (paused)
+    {
+        mPausedOwners << owner;
+        connect(owner, SIGNAL(destroyed(QObject*)), this, SLOT(ownerDestroyed(QObject*)), Qt::UniqueConnection);
+    }
+    else
+    {
+        mPausedOwners.remove(owner);
+    }
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<QPointer<TickSubscription> > catchUp;
+    foreach (TickSubscription *sub, mSubscriptions)
+    {
+        if (sub->owner() != owner || sub->mPaused == paused)
+            continue;
+
+        sub->mPaused = paused;
+        if (!paused)
+        {
+            if (sub->mMissed || sub->mNext <= now)
+                catchUp << sub;
+
+            sub->mMissed = false;
+            sub->mNext = nextTick(now, sub->interval());
+        }
+    }
+
+    schedule();
+
+    // One tick for all the missed ones.
+    foreach (QPointer<TickSubscription> sub, catchUp)
+    {
+        if (sub)
+            emitTick(sub);
+    }
+}
+
+
+/************************************************
+ The system clock was changed.
+ ************************************************/
+void TickService::resetTicks(qint64 now)
+{
+    foreach (TickSubscription *sub, mSubscriptions)
+        sub->mNext = nextTick(now, sub->interval());
+
+    mArmedAt = 0;
+}
+
+
+/************************************************
+
+ ************************************************/
+void TickService::timeout()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    if (mTimerFd >= 0)
+    {
+        quint64 expirations;
+        if (read(mTimerFd, &expirations, sizeof(expirations)) < 0)
+        {
+            if (errno == ECANCELED)
+            {
+                resetTicks(now);
+                schedule();
+            }
+            return;
+        }
+    }
+
+    mArmedAt = 0;
+    mWakeupCount++;
+
+    QList<QPointer<TickSubscription> > due;
+    foreach (TickSubscription *sub, mSubscriptions)
+    {
+        if (sub->mNext > now + TICK_SLACK)
+            continue;
+
+        sub->mNext = nextTick(qMax(now, sub->mNext), sub->interval());
+        if (sub->mPaused)
+            sub->mMissed = true;
+        else
+            due << sub;
+    }
+
+    schedule();
+
+    // The receivers may unsubscribe or subscribe again here.
+    foreach (QPointer<TickSubscription> sub, due)
+    {
+        if (sub)
+            emitTick(sub);
+    }
+}
+
+
+/************************************************
+ All the ticks are emitted in one dispatch of our
+ socket notifier, so the wakeup statistics credit
+ each of them to the plugin of its receiver.
+ ************************************************/
+void TickService::emitTick(TickSubscription *sub)
+{
+    WakeupStats *stats = WakeupStats::instance();
+    if (!stats->isEnabled())
+    {
+        emit sub->tick();
+        return;
+    }
+
+    // The receiver can be deleted by the handler, find the plugin before.
+    Plugin *plugin = stats->findPlugin(sub->parent());
+    qint64 accounted = stats->accountedTime();
+    qint64 start = WakeupStats::threadCpuTime();
+    emit sub->tick();
+    qint64 nested = stats->accountedTime() - accounted;
+    stats->addWakeup(plugin, QEvent::Timer, WakeupStats::threadCpuTime() - start - nested);
+}
+
+
+/************************************************
+
+ ************************************************/
+void TickService::schedule()
+{
+    qint64 next = 0;
+    foreach (TickSubscription *sub, mSubscriptions)
+    {
+        if (!sub->mPaused && (!next || sub->mNext < next))
+            next = sub->mNext;
+    }
+
+    if (next == mArmedAt)
+        return;
+
+    mArmedAt = next;
+
+    if (mTimerFd < 0)
+    {
+        if (next)
+            mTimer.start(qMax(qint64(0), next - QDateTime::currentMSecsSinceEpoch()));
+        else
+            mTimer.stop();
+        return;
+    }
+
+    // The zero value disarms the timer.
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = 0;
+    spec.it_interval.tv_nsec = 0;
+    spec.it_value.tv_sec = next / 1000;
+    spec.it_value.tv_nsec = (next % 1000) * 1000000;
+    if (timerfd_settime(mTimerFd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, 0) < 0)
+    {
+        if (errno == ECANCELED)
+        {
+            // The clock was changed just now.
+            resetTicks(QDateTime::currentMSecsSinceEpoch());
+            schedule();
+        }
+        else
+        {
+            qWarning() << "TickService: can't arm the timer";
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef TICKSERVICE_H
+#define TICKSERVICE_H
+
+#include <QObject>
+#include <QList>
+#include <QSet>
+#include <QTimer>
+#include "lxqtpanelglobals.h"
+
+class QSocketNotifier;
+
+/*! One subscription of TickService. It's a child of the receiver, so it's
+    removed together with the receiver.
+ */
+class LXQT_PANEL_API TickSubscription : public QObject
+{
+    Q_OBJECT
+public:
+    TickSubscription(QObject *owner, int interval, QObject *receiver);
+
+    QObject *owner() const { return mOwner; }
+    int interval() const { return mInterval; }
+
+    // Kept by TickService.
+    qint64 mNext;
+    bool mPaused;
+    bool mMissed;
+
+signals:
+    void tick();
+
+private:
+    QObject *mOwner;
+    int mInterval;
+};
+
+
+/*! \brief The TickService class is the shared timer of the panel plugins.
+
+    The plugins subscribe through ILxQtPanel::subscribeTick(). The ticks of
+    all subscriptions are aligned to the interval boundaries counted from the
+    Epoch, so the subscriptions with intervals of whole seconds fire together
+    and the panel wakes up once for all of them.
+
+    The service uses one timerfd armed with the absolute wall clock time of the
+    nearest tick. The timerfd also tells us when the system clock is changed,
+    then all the ticks are recalculated. Without the timerfd a precise QTimer
+    is used.
+
+    The subscriptions of one owner (a panel) can be paused. The paused
+    subscriptions don't wake up the panel; when they are resumed, each of them
+    that missed a tick gets one tick at once.
+ */
+class LXQT_PANEL_API TickService : public QObject
+{
+    Q_OBJECT
+public:
+    static TickService *instance();
+
+    void subscribe(QObject *owner, int interval, QObject *receiver, const char *member);
+    void unsubscribe(QObject *owner, QObject *receiver);
+
+    void setPaused(QObject *owner, bool paused);
+
+    int wakeupCount() const { return mWakeupCount; }
+
+private slots:
+    void timeout();
+    void subscriptionDestroyed(QObject *subscription);
+    void ownerDestroyed(QObject *owner);
+
+private:
+    TickService();
+    ~TickService();
+
+    int mTimerFd;
+    QSocketNotifier *mNotifier;
+    QTimer mTimer;
+    qint64 mArmedAt;
+    QList<TickSubscription*> mSubscriptions;
+    QSet<QObject*> mPausedOwners;
+    int mWakeupCount;
+
+    void schedule();
+    void emitTick(TickSubscription *sub);
+    void resetTicks(qint64 now);
+    static qint64 nextTick(qint64 now, int interval);
+};
+
+#endif // TICKSERVICE_H
@@ -0,0 +1,267 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "wakeupstats.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QSocketNotifier>
+#include <csignal>
+#include <ctime>
+#include <sys/socket.h>
+#include <unistd.h>
+
+int WakeupStats::mSignalFd[2] = { -1, -1 };
+
+/************************************************
+
+ ************************************************/
+WakeupStats *WakeupStats::instance()
+{
+    static WakeupStats stats;
+    return &stats;
+}
+
+
+/************************************************
+
+ ************************************************/
+WakeupStats::WakeupStats():
+    QObject(),
+    mSignalNotifier(0),
+    mEnabled(statsRequested()),
+    mAccountedTime(0)
+{
+    mPanel.name = "lxqt-panel";
+    mPanel.since.start();
+}
+
+
+/************************************************
+
+ ************************************************/
+bool WakeupStats::statsRequested()
+{
+    static bool requested = !qgetenv("LXQT_PANEL_STATS").isEmpty();
+    return requested;
+}
+
+
+/************************************************
+ The counts start from zero when turned on.
+ ************************************************/
+void WakeupStats::setEnabled(bool enabled)
+{
+    if (mEnabled == enabled)
+        return;
+
+    mEnabled = enabled;
+    if (!mEnabled)
+        return;
+
+    QString name = mPanel.name;
+    mPanel = Entry();
+    mPanel.name = name;
+    mPanel.since.start();
+
+    QMutableHashIterator<Plugin*, Entry> it(mEntries);
+    while (it.hasNext())
+    {
+        Entry &entry = it.next().value();
+        entry.timers = 0;
+        entry.sockets = 0;
+        entry.cpuTime = 0;
+        entry.since.start();
+    }
+}
+
+
+/************************************************
+
+ ************************************************/
+void WakeupStats::addPlugin(Plugin *plugin, QObject *pluginObject, const QString &name)
+{
+    mRoots.insert(plugin, plugin);
+    if (pluginObject)
+        mRoots.insert(pluginObject, plugin);
+
+    Entry &entry = mEntries[plugin];
+    entry.name = name;
+    entry.since.start();
+}
+
+
+/************************************************
+
+ ************************************************/
+void WakeupStats::removePlugin(Plugin *plugin)
+{
+    QMutableHashIterator<QObject*, Plugin*> it(mRoots);
+    while (it.hasNext())
+    {
+        if (it.next().value() == plugin)
+            it.remove();
+    }
+
+    mEntries.remove(plugin);
+}
+
+
+/************************************************
+
+ ************************************************/
+Plugin *WakeupStats::findPlugin(QObject *receiver) const
+{
+    for (QObject *obj = receiver; obj; obj = obj->parent())
+    {
+        Plugin *plugin = mRoots.value(obj);
+        if (plugin)
+            return plugin;
+    }
+
+    return 0;
+}
+
+
+/************************************************
+
+ ************************************************/
+void WakeupStats::addWakeup(Plugin *plugin, QEvent::Type type, qint64 cpuTime)
+{
+    mAccountedTime += cpuTime;
+
+    Entry *entry = &mPanel;
+    if (plugin)
+    {
+        // The plugin might be removed while it was handling the event.
+        QHash<Plugin*, Entry>::iterator it = mEntries.find(plugin);
+        if (it == mEntries.end())
+            return;
+
+        entry = &it.value();
+    }
+
+    if (type == QEvent::Timer)
+        entry->timers++;
+    else
+        entry->sockets++;
+
+    entry->cpuTime += cpuTime;
+}
+
+
+/************************************************
+
+ ************************************************/
+qint64 WakeupStats::threadCpuTime()
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0;
+
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/************************************************
+
+ ************************************************/
+void WakeupStats::installDumpSignal()
+{
+    if (mSignalNotifier)
+        return;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, mSignalFd) != 0)
+    {
+        qWarning() << "Can't create the socket pair for SIGUSR1";
+        return;
+    }
+
+    // The instance outlives the application, the notifier must not.
+    mSignalNotifier = new QSocketNotifier(mSignalFd[1], QSocketNotifier::Read, qApp);
+    connect(mSignalNotifier, SIGNAL(activated(int)), this, SLOT(signalReceived()));
+
+    struct sigaction usr1;
+    usr1.sa_handler = signalHandler;
+    sigemptyset(&usr1.sa_mask);
+    usr1.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &usr1, 0);
+}
+
+
+/************************************************
+ Only async-signal-safe calls are allowed here.
+ ************************************************/
+void WakeupStats::signalHandler(int)
+{
+    char c = 1;
+    if (::write(mSignalFd[0], &c, sizeof(c)) < 0)
+        return;
+}
+
+
+/************************************************
+
+ ************************************************/
+void WakeupStats::signalReceived()
+{
+    char c;
+    if (::read(mSignalFd[1], &c, sizeof(c)) < 0)
+        return;
+
+    if (!mEnabled)
+    {
+        setEnabled(true);
+        qDebug("Counting the wakeups, send SIGUSR1 again to print them");
+        return;
+    }
+
+    dump();
+}
+
+
+/************************************************
+
+ ************************************************/
+void WakeupStats::dump()
+{
+    qDebug("Wakeups since the counting started (%lld s):", mPanel.since.elapsed() / 1000);
+    dumpEntry(mPanel);
+    foreach (const Entry &entry, mEntries)
+        dumpEntry(entry);
+}
+
+
+/************************************************
+
+ ************************************************/
+void WakeupStats::dumpEntry(const Entry &entry) const
+{
+    double minutes = qMax(entry.since.elapsed(), qint64(1)) / 60000.0;
+    qDebug("  %-40s timers: %8d (%7.1f/min)  sockets: %8d (%7.1f/min)  cpu: %9.1f ms",
+           qPrintable(entry.name),
+           entry.timers, entry.timers / minutes,
+           entry.sockets, entry.sockets / minutes,
+           entry.cpuTime / 1000000.0);
+}
@@ -0,0 +1,124 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef WAKEUPSTATS_H
+#define WAKEUPSTATS_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QHash>
+#include <QString>
+#include "lxqtpanelglobals.h"
+
+class QSocketNotifier;
+class Plugin;
+
+/*! \brief The WakeupStats class counts the timer and socket notifier wakeups
+    and the CPU time spent in them for each plugin.
+
+    LxQtPanelApplication::notify() passes all the timer and socket events of the
+    GUI thread here. The receiver belongs to the plugin if the plugin object or
+    the Plugin widget is one of its ancestors, other events are counted for the
+    panel itself.
+
+    The statistics are printed when the panel gets SIGUSR1:
+        kill -USR1 $(pidof lxqt-panel)
+
+    The counting costs two clock_gettime() calls and a walk of the parent
+    chain per event, so it is off by default. It is turned on by the first
+    SIGUSR1, or from the start when the LXQT_PANEL_STATS environment
+    variable is set (see statsRequested()).
+ */
+class LXQT_PANEL_API WakeupStats : public QObject
+{
+    Q_OBJECT
+public:
+    static WakeupStats *instance();
+
+    /*! Returns true if the LXQT_PANEL_STATS environment variable is set, then
+        the panel prints its statistics.
+     */
+    static bool statsRequested();
+
+    bool isEnabled() const { return mEnabled; }
+    void setEnabled(bool enabled);
+
+    void addPlugin(Plugin *plugin, QObject *pluginObject, const QString &name);
+    void removePlugin(Plugin *plugin);
+
+    /*! Returns the plugin the receiver belongs to, 0 for the panel itself.
+     */
+    Plugin *findPlugin(QObject *receiver) const;
+
+    void addWakeup(Plugin *plugin, QEvent::Type type, qint64 cpuTime);
+
+    /*! Returns the sum of the CPU time passed to addWakeup(). The nested
+        dispatches (e.g. the TickService ticks inside its socket notifier)
+        are credited to their plugins, the outer dispatch subtracts them.
+     */
+    qint64 accountedTime() const { return mAccountedTime; }
+
+    /*! Returns the CPU time of the calling thread in ns.
+     */
+    static qint64 threadCpuTime();
+
+    /*! Installs the SIGUSR1 handler, the dump is done in the GUI thread.
+     */
+    void installDumpSignal();
+
+public slots:
+    void dump();
+
+private slots:
+    void signalReceived();
+
+private:
+    WakeupStats();
+
+    struct Entry
+    {
+        Entry(): timers(0), sockets(0), cpuTime(0) {}
+        QString name;
+        int timers;
+        int sockets;
+        qint64 cpuTime;
+        QElapsedTimer since;
+    };
+
+    QHash<QObject*, Plugin*> mRoots;
+    QHash<Plugin*, Entry> mEntries;
+    Entry mPanel;
+    QSocketNotifier *mSignalNotifier;
+    bool mEnabled;
+    qint64 mAccountedTime;
+
+    static int mSignalFd[2];
+    static void signalHandler(int);
+
+    void dumpEntry(const Entry &entry) const;
+};
+
+#endif // WAKEUPSTATS_H
@@ -0,0 +1,277 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#include "windowiconcache.h"
+#include <KF5/KWindowSystem/KWindowSystem>
+#include <KF5/KWindowSystem/KWindowInfo>
+#include <QCryptographicHash>
+#include <QImage>
+#include <QX11Info>
+#include <xcb/xcb.h>
+#include <cstdlib>
+
+// The memory budget of the cache, in bytes.
+#define ICON_CACHE_BUDGET (4 * 1024 * 1024)
+
+// The largest image in _NET_WM_ICON we accept.
+#define ICON_MAX_SIZE 1024
+
+namespace
+{
+    // Reads the words of _NET_WM_ICON from the offset.
+    // Returns 0 unless all of them are there.
+    xcb_get_property_reply_t *readIconWords(xcb_connection_t *c, WId window, xcb_atom_t atom,
+                                            quint32 offset, quint32 count)
+    {
+        xcb_generic_error_t *error = 0;
+        xcb_get_property_reply_t *reply = xcb_get_property_reply(c,
+            xcb_get_property(c, false, window, atom, XCB_ATOM_CARDINAL, offset, count), &error);
+        free(error);
+        if (reply && (reply->format != 32 || xcb_get_property_value_length(reply) < int(count * 4)))
+        {
+            free(reply);
+            reply = 0;
+        }
+        return reply;
+    }
+}
+
+/************************************************
+
+ ************************************************/
+WindowIconCache *WindowIconCache::instance()
+{
+    static WindowIconCache cache;
+    return &cache;
+}
+
+
+/************************************************
+
+ ************************************************/
+WindowIconCache::WindowIconCache():
+    QObject(),
+    mCache(ICON_CACHE_BUDGET),
+    mIconAtom(XCB_ATOM_NONE),
+    mHitCount(0),
+    mMissCount(0)
+{
+    xcb_connection_t *c = QX11Info::connection();
+    const char *name = "_NET_WM_ICON";
+    xcb_generic_error_t *error = 0;
+    xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(c, xcb_intern_atom(c, false, qstrlen(name), name), &error);
+    free(error);
+    if (reply)
+        mIconAtom = reply->atom;
+    free(reply);
+
+    connect(KWindowSystem::self(), SIGNAL(windowRemoved(WId)), SLOT(windowRemoved(WId)));
+    connect(KWindowSystem::self(), SIGNAL(windowChanged(WId, NET::Properties, NET::Properties2)),
+            SLOT(windowChanged(WId, NET::Properties, NET::Properties2)));
+}
+
+
+/************************************************
+
+ ************************************************/
+QPixmap WindowIconCache::icon(WId window, int size)
+{
+    QHash<WId, QPair<int, QByteArray> >::const_iterator it = mWindowKeys.constFind(window);
+    if (it != mWindowKeys.constEnd() && it.value().first == size)
+    {
+        QPixmap *pixmap = mCache.object(it.value().second);
+        if (pixmap)
+        {
+            ++mHitCount;
+            return *pixmap;
+        }
+    }
+
+    QImage image;
+    QPixmap result;
+    QByteArray key = readNetIcon(window, size, &image);
+    if (key.isEmpty())
+    {
+        // The WM_HINTS pixmap is the window's own, it's kept for this window only.
+        result = KWindowSystem::icon(window, size, size, true, KWindowSystem::WMHints);
+        if (!result.isNull())
+        {
+            key = "window:" + QByteArray::number(quint64(window)) + ':' + QByteArray::number(size);
+        }
+        else
+        {
+            // The icons from the class or the theme are shared by the windows
+            // of the class. The windows without a class can't share them.
+            QByteArray windowClass = KWindowInfo(window, 0, NET::WM2WindowClass).windowClassClass();
+            if (!windowClass.isEmpty())
+                key = "class:" + windowClass + ':' + QByteArray::number(size);
+        }
+    }
+
+    if (!key.isEmpty())
+    {
+        forgetWindow(window);
+        mWindowKeys.insert(window, qMakePair(size, key));
+
+        QPixmap *pixmap = result.isNull() ? mCache.object(key) : 0;
+        if (pixmap)
+        {
+            ++mHitCount;
+            return *pixmap;
+        }
+    }
+
+    ++mMissCount;
+    if (!image.isNull())
+        result = QPixmap::fromImage(image);
+    else if (result.isNull())
+        result = KWindowSystem::icon(window, size, size, true, KWindowSystem::ClassHint | KWindowSystem::XApp);
+
+    if (!result.isNull() && !key.isEmpty())
+        mCache.insert(key, new QPixmap(result), result.width() * result.height() * result.depth() / 8);
+
+    return result;
+}
+
+
+/************************************************
+ Walks _NET_WM_ICON by the width and height headers of
+ its images, so only the headers and the chosen image
+ are read from the X server. The smallest image that
+ is not smaller than the size is picked, or the largest
+ one. The images bigger than ICON_MAX_SIZE are skipped
+ by their declared length. The key is the hash of the
+ image.
+ ************************************************/
+QByteArray WindowIconCache::readNetIcon(WId window, int size, QImage *image) const
+{
+    if (mIconAtom == XCB_ATOM_NONE)
+        return QByteArray();
+
+    xcb_connection_t *c = QX11Info::connection();
+
+    // The first header also tells us the length of the whole property.
+    xcb_get_property_reply_t *reply = readIconWords(c, window, mIconAtom, 0, 2);
+    if (!reply)
+        return QByteArray();
+    const quint64 length = (quint64(xcb_get_property_value_length(reply)) + reply->bytes_after) / 4;
+
+    quint64 offset = 0;
+    quint64 bestOffset = 0;
+    quint32 bestWidth = 0;
+    quint32 bestHeight = 0;
+
+    while (offset + 2 <= length)
+    {
+        if (!reply)
+            reply = readIconWords(c, window, mIconAtom, offset, 2);
+        if (!reply)
+            break;
+
+        const quint32 *header = static_cast<const quint32 *>(xcb_get_property_value(reply));
+        quint32 width = header[0];
+        quint32 height = header[1];
+        free(reply);
+        reply = 0;
+
+        // A broken header, we can't find the next image.
+        if (width == 0 || height == 0 || quint64(width) * height > length - offset - 2)
+            break;
+
+        if (width <= ICON_MAX_SIZE && height <= ICON_MAX_SIZE)
+        {
+            bool better;
+            if (!bestWidth)
+                better = true;
+            else if (int(bestWidth) < size)
+                better = width > bestWidth;
+            else
+                better = int(width) >= size && width < bestWidth;
+
+            if (better)
+            {
+                bestOffset = offset + 2;
+                bestWidth = width;
+                bestHeight = height;
+            }
+        }
+
+        offset += 2 + quint64(width) * height;
+    }
+    free(reply);
+
+    if (!bestWidth)
+        return QByteArray();
+
+    reply = readIconWords(c, window, mIconAtom, bestOffset, bestWidth * bestHeight);
+    if (!reply || xcb_get_property_value_length(reply) != int(bestWidth * bestHeight * 4))
+    {
+        free(reply);
+        return QByteArray();
+    }
+
+    QByteArray pixels(static_cast<const char *>(xcb_get_property_value(reply)), bestWidth * bestHeight * 4);
+    free(reply);
+
+    // The image is scaled by the button anyway, a bigger one is kept as is.
+    *image = QImage(reinterpret_cast<const uchar *>(pixels.constData()), bestWidth, bestHeight,
+                    QImage::Format_ARGB32).copy();
+
+    return "net:" + QCryptographicHash::hash(pixels, QCryptographicHash::Sha1).toHex()
+           + ':' + QByteArray::number(bestWidth) + 'x' + QByteArray::number(bestHeight);
+}
+
+
+/************************************************
+
+ ************************************************/
+void WindowIconCache::windowRemoved(WId window)
+{
+    forgetWindow(window);
+}
+
+
+/************************************************
+
+ ************************************************/
+void WindowIconCache::windowChanged(WId window, NET::Properties prop, NET::Properties2 prop2)
+{
+    if (prop.testFlag(NET::WMIcon) || prop2.testFlag(NET::WM2WindowClass))
+        forgetWindow(window);
+}
+
+
+/************************************************
+ The shared pixmaps stay in the cache, other windows
+ may use them. Only the pixmap of the window's own
+ WM_HINTS icon is dropped.
+ ************************************************/
+void WindowIconCache::forgetWindow(WId window)
+{
+    QByteArray key = mWindowKeys.take(window).second;
+    if (key.startsWith("window:"))
+        mCache.remove(key);
+}
@@ -0,0 +1,81 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#ifndef WINDOWICONCACHE_H
+#define WINDOWICONCACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QCache>
+#include <QPair>
+#include <QPixmap>
+#include <KF5/KWindowSystem/NETWM>
+#include "lxqtpanelglobals.h"
+
+/*! \brief The WindowIconCache class keeps the window icons for the plugins
+    of all the panels.
+
+    Only the image headers of the _NET_WM_ICON property and the image that
+    suits the requested size best are read from the X server. The images
+    are keyed by a hash of their content, so all the windows with the same
+    icon share one pixmap. The windows without _NET_WM_ICON fall back to
+    KWindowSystem. A WM_HINTS icon is cached for its window only, the icons
+    from the class or the theme are keyed by the WM_CLASS; without a class
+    they aren't cached.
+
+    The cache holds at most ICON_CACHE_BUDGET bytes of pixmaps, the least
+    recently used ones are evicted first.
+ */
+class LXQT_PANEL_API WindowIconCache : public QObject
+{
+    Q_OBJECT
+public:
+    static WindowIconCache *instance();
+
+    QPixmap icon(WId window, int size);
+
+    int hitCount() const { return mHitCount; }
+    int missCount() const { return mMissCount; }
+
+private slots:
+    void windowRemoved(WId window);
+    void windowChanged(WId window, NET::Properties prop, NET::Properties2 prop2);
+
+private:
+    WindowIconCache();
+
+    // The size and the key of the icon of the window.
+    QHash<WId, QPair<int, QByteArray> > mWindowKeys;
+    QCache<QByteArray, QPixmap> mCache;
+    quint32 mIconAtom;
+    int mHitCount;
+    int mMissCount;
+
+    QByteArray readNetIcon(WId window, int size, QImage *image) const;
+    void forgetWindow(WId window);
+};
+
+#endif // WINDOWICONCACHE_H
@@ -0,0 +1,62 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#ifndef WINDOWPROPERTIES_H
+#define WINDOWPROPERTIES_H
+
+#include <QString>
+#include <QtGui/qwindowdefs.h>
+#include <KF5/KWindowSystem/NETWM>
+
+/*! The properties of one top level window, as cached by the panel.
+    See ILxQtPanel::windowProperties().
+ */
+struct WindowProperties
+{
+    WindowProperties():
+        valid(false),
+        windowType(NET::Unknown),
+        state(0),
+        desktop(0),
+        transientFor(0)
+    {
+    }
+
+    bool valid;
+    NET::WindowType windowType;
+    NET::States state;
+    int desktop;
+    WId transientFor;
+    QString name;
+    // The raw _NET_WM_VISIBLE_NAME, empty when the window manager doesn't set it.
+    QString visibleName;
+
+    bool hasState(NET::States s) const { return (state & s) == s; }
+    bool isOnDesktop(int d) const { return desktop == NET::OnAllDesktops || desktop == d; }
+    QString title() const { return visibleName.isEmpty() ? name : visibleName; }
+};
+
+#endif // WINDOWPROPERTIES_H
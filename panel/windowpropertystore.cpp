@@ -0,0 +1,442 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#include "windowpropertystore.h"
+#include <KF5/KWindowSystem/KWindowSystem>
+#include <KF5/KWindowSystem/KWindowInfo>
+#include <QX11Info>
+#include <QVector>
+#include <xcb/xcb.h>
+#include <cstdlib>
+
+// The properties kept in the store.
+#define STORE_PROPERTIES  (NET::WMWindowType | NET::WMState | NET::WMDesktop | NET::WMName | NET::WMVisibleName)
+#define STORE_PROPERTIES2 (NET::WM2TransientFor)
+
+// The names are read in the batch up to this length, in 32-bit units.
+// The longer ones are read again in full, like KWindowInfo does.
+#define NAME_LENGTH 256
+
+namespace
+{
+    enum AtomId {
+        Atom_NET_WM_WINDOW_TYPE,
+        Atom_NET_WM_STATE,
+        Atom_NET_WM_DESKTOP,
+        Atom_NET_WM_NAME,
+        Atom_NET_WM_VISIBLE_NAME,
+        AtomUTF8_STRING,
+        AtomFirstType,
+        AtomLastType = AtomFirstType + 15,
+        AtomFirstState,
+        AtomLastState = AtomFirstState + 11,
+        AtomCount
+    };
+
+    // The same order as in the AtomId enum.
+    const char *atomNames[AtomCount] = {
+        "_NET_WM_WINDOW_TYPE",
+        "_NET_WM_STATE",
+        "_NET_WM_DESKTOP",
+        "_NET_WM_NAME",
+        "_NET_WM_VISIBLE_NAME",
+        "UTF8_STRING",
+        // window types
+        "_NET_WM_WINDOW_TYPE_NORMAL",
+        "_NET_WM_WINDOW_TYPE_DESKTOP",
+        "_NET_WM_WINDOW_TYPE_DOCK",
+        "_NET_WM_WINDOW_TYPE_TOOLBAR",
+        "_NET_WM_WINDOW_TYPE_MENU",
+        "_NET_WM_WINDOW_TYPE_DIALOG",
+        "_KDE_NET_WM_WINDOW_TYPE_OVERRIDE",
+        "_KDE_NET_WM_WINDOW_TYPE_TOPMENU",
+        "_NET_WM_WINDOW_TYPE_UTILITY",
+        "_NET_WM_WINDOW_TYPE_SPLASH",
+        "_NET_WM_WINDOW_TYPE_DROPDOWN_MENU",
+        "_NET_WM_WINDOW_TYPE_POPUP_MENU",
+        "_NET_WM_WINDOW_TYPE_TOOLTIP",
+        "_NET_WM_WINDOW_TYPE_NOTIFICATION",
+        "_NET_WM_WINDOW_TYPE_COMBO",
+        "_NET_WM_WINDOW_TYPE_DND",
+        // states
+        "_NET_WM_STATE_MODAL",
+        "_NET_WM_STATE_STICKY",
+        "_NET_WM_STATE_MAXIMIZED_VERT",
+        "_NET_WM_STATE_MAXIMIZED_HORZ",
+        "_NET_WM_STATE_SHADED",
+        "_NET_WM_STATE_SKIP_TASKBAR",
+        "_NET_WM_STATE_SKIP_PAGER",
+        "_NET_WM_STATE_HIDDEN",
+        "_NET_WM_STATE_FULLSCREEN",
+        "_NET_WM_STATE_ABOVE",
+        "_NET_WM_STATE_BELOW",
+        "_NET_WM_STATE_DEMANDS_ATTENTION"
+    };
+
+    // The same order as the window type atoms.
+    const NET::WindowType windowTypes[AtomLastType - AtomFirstType + 1] = {
+        NET::Normal, NET::Desktop, NET::Dock, NET::Toolbar, NET::Menu, NET::Dialog,
+        NET::Override, NET::TopMenu, NET::Utility, NET::Splash, NET::DropdownMenu,
+        NET::PopupMenu, NET::Tooltip, NET::Notification, NET::ComboBox, NET::DNDIcon
+    };
+
+    // The same order as the state atoms.
+    const NET::State states[AtomLastState - AtomFirstState + 1] = {
+        NET::Modal, NET::Sticky, NET::MaxVert, NET::MaxHoriz, NET::Shaded, NET::SkipTaskbar,
+        NET::SkipPager, NET::Hidden, NET::FullScreen, NET::KeepAbove, NET::KeepBelow,
+        NET::DemandsAttention
+    };
+
+    // The cookies of one window in a batch.
+    struct PropertyCookies
+    {
+        xcb_get_property_cookie_t type;
+        xcb_get_property_cookie_t state;
+        xcb_get_property_cookie_t desktop;
+        xcb_get_property_cookie_t transientFor;
+        xcb_get_property_cookie_t netName;
+        xcb_get_property_cookie_t visibleName;
+        xcb_get_property_cookie_t wmName;
+    };
+
+    xcb_get_property_cookie_t getProperty(xcb_connection_t *c, WId window, xcb_atom_t property,
+                                          xcb_atom_t type, uint32_t length)
+    {
+        return xcb_get_property(c, false, window, property, type, 0, length);
+    }
+
+    // The errors (BadWindow for the windows that are gone) are taken
+    // here, so they don't end up in the Qt event queue.
+    xcb_get_property_reply_t *propertyReply(xcb_connection_t *c, xcb_get_property_cookie_t cookie)
+    {
+        xcb_generic_error_t *error = 0;
+        xcb_get_property_reply_t *reply = xcb_get_property_reply(c, cookie, &error);
+        free(error);
+        return reply;
+    }
+
+    QString nameFromReply(xcb_get_property_reply_t *reply, xcb_atom_t utf8)
+    {
+        if (!reply || reply->format != 8)
+            return QString();
+
+        const char *data = static_cast<const char *>(xcb_get_property_value(reply));
+        int length = xcb_get_property_value_length(reply);
+        if (reply->type == utf8)
+            return QString::fromUtf8(data, length);
+        if (reply->type == XCB_ATOM_STRING)
+            return QString::fromLatin1(data, length);
+        return QString::fromLocal8Bit(data, length);
+    }
+
+    // The rest of a name longer than the batch request is read
+    // with a second request for the whole property.
+    QString fullName(xcb_connection_t *c, xcb_get_property_reply_t *reply, WId window,
+                     xcb_atom_t property, xcb_atom_t type, xcb_atom_t utf8)
+    {
+        if (reply && reply->bytes_after)
+        {
+            uint32_t length = (xcb_get_property_value_length(reply) + reply->bytes_after + 3) / 4;
+            xcb_get_property_reply_t *full = propertyReply(c, getProperty(c, window, property, type, length));
+            if (full)
+            {
+                QString name = nameFromReply(full, utf8);
+                free(full);
+                return name;
+            }
+        }
+
+        return nameFromReply(reply, utf8);
+    }
+}
+
+/************************************************
+
+ ************************************************/
+WindowPropertyStore *WindowPropertyStore::instance()
+{
+    static WindowPropertyStore store;
+    return &store;
+}
+
+
+/************************************************
+
+ ************************************************/
+WindowPropertyStore::WindowPropertyStore():
+    QObject(),
+    mFetchCount(0),
+    mHitCount(0),
+    mBatchCount(0)
+{
+    xcb_connection_t *c = QX11Info::connection();
+    QVector<xcb_intern_atom_cookie_t> cookies(AtomCount);
+    for (int i = 0; i < AtomCount; ++i)
+        cookies[i] = xcb_intern_atom(c, false, qstrlen(atomNames[i]), atomNames[i]);
+
+    mAtoms.resize(AtomCount);
+    for (int i = 0; i < AtomCount; ++i)
+    {
+        xcb_generic_error_t *error = 0;
+        xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(c, cookies[i], &error);
+        free(error);
+        mAtoms[i] = reply ? reply->atom : XCB_ATOM_NONE;
+        free(reply);
+    }
+
+    fetchBatch(KWindowSystem::windows());
+
+    connect(KWindowSystem::self(), SIGNAL(windowAdded(WId)), SLOT(windowAdded(WId)));
+    connect(KWindowSystem::self(), SIGNAL(windowRemoved(WId)), SLOT(windowRemoved(WId)));
+    connect(KWindowSystem::self(), SIGNAL(windowChanged(WId, NET::Properties, NET::Properties2)),
+            SLOT(windowChanged(WId, NET::Properties, NET::Properties2)));
+}
+
+
+/************************************************
+ The windows that aren't managed (e.g. the leader
+ of a transient window) are cached apart, we have no
+ notifications for them. They are read again when
+ a transient window of theirs is removed.
+ ************************************************/
+WindowProperties WindowPropertyStore::properties(WId window) const
+{
+    QHash<WId, WindowProperties>::const_iterator it = mWindows.constFind(window);
+    if (it != mWindows.constEnd())
+    {
+        ++mHitCount;
+        return it.value();
+    }
+
+    it = mUnmanaged.constFind(window);
+    if (it != mUnmanaged.constEnd())
+    {
+        ++mHitCount;
+        return it.value();
+    }
+
+    WindowProperties props;
+    fetch(props, window, STORE_PROPERTIES, STORE_PROPERTIES2);
+    mUnmanaged.insert(window, props);
+    return props;
+}
+
+
+/************************************************
+
+ ************************************************/
+void WindowPropertyStore::fetch(WindowProperties &props, WId window, NET::Properties prop, NET::Properties2 prop2) const
+{
+    // The names are always read together, see below.
+    if (prop & (NET::WMName | NET::WMVisibleName))
+        prop |= NET::WMName | NET::WMVisibleName;
+
+    ++mFetchCount;
+    KWindowInfo info(window, prop, prop2);
+    props.valid = info.valid();
+    if (!props.valid)
+        return;
+
+    if (prop & NET::WMWindowType)
+        props.windowType = info.windowType(NET::AllTypesMask);
+
+    if (prop & NET::WMState)
+        props.state = info.state();
+
+    if (prop & NET::WMDesktop)
+        props.desktop = info.desktop();
+
+    // KWindowInfo::visibleName() falls back to the name, but only the
+    // _NET_WM_VISIBLE_NAME is kept, WindowProperties::title() falls back.
+    if (prop & NET::WMName)
+    {
+        props.name = info.name();
+        QString visibleName = info.visibleName();
+        props.visibleName = visibleName == props.name ? QString() : visibleName;
+    }
+
+    if (prop2 & NET::WM2TransientFor)
+        props.transientFor = info.transientFor();
+}
+
+
+/************************************************
+
+ ************************************************/
+void WindowPropertyStore::windowAdded(WId window)
+{
+    mUnmanaged.remove(window);
+    if (mWindows.contains(window))
+        return;
+
+    // All the windows KWindowSystem knows and we don't yet are fetched in
+    // one batch. Only its windows are cached, so each of them gets its
+    // windowRemoved().
+    QList<WId> windows;
+    windows << window;
+    foreach (WId w, KWindowSystem::windows())
+    {
+        if (w != window && !mWindows.contains(w))
+            windows << w;
+    }
+
+    fetchBatch(windows);
+}
+
+
+/************************************************
+ Sends the requests for all the windows first and
+ then collects the replies, so the whole batch
+ costs about one round trip to the X server.
+ ************************************************/
+void WindowPropertyStore::fetchBatch(const QList<WId> &windows)
+{
+    if (windows.isEmpty())
+        return;
+
+    ++mBatchCount;
+    mFetchCount += windows.count();
+
+    xcb_connection_t *c = QX11Info::connection();
+    QVector<PropertyCookies> cookies(windows.count());
+    for (int i = 0; i < windows.count(); ++i)
+    {
+        WId w = windows.at(i);
+        PropertyCookies &ck = cookies[i];
+        ck.type         = getProperty(c, w, mAtoms[Atom_NET_WM_WINDOW_TYPE], XCB_ATOM_ATOM, 64);
+        ck.state        = getProperty(c, w, mAtoms[Atom_NET_WM_STATE], XCB_ATOM_ATOM, 64);
+        ck.desktop      = getProperty(c, w, mAtoms[Atom_NET_WM_DESKTOP], XCB_ATOM_CARDINAL, 1);
+        ck.transientFor = getProperty(c, w, XCB_ATOM_WM_TRANSIENT_FOR, XCB_ATOM_WINDOW, 1);
+        ck.netName      = getProperty(c, w, mAtoms[Atom_NET_WM_NAME], mAtoms[AtomUTF8_STRING], NAME_LENGTH);
+        ck.visibleName  = getProperty(c, w, mAtoms[Atom_NET_WM_VISIBLE_NAME], mAtoms[AtomUTF8_STRING], NAME_LENGTH);
+        ck.wmName       = getProperty(c, w, XCB_ATOM_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY, NAME_LENGTH);
+    }
+
+    for (int i = 0; i < windows.count(); ++i)
+    {
+        const PropertyCookies &ck = cookies.at(i);
+        WindowProperties props;
+        xcb_get_property_reply_t *reply;
+
+        // Any reply tells us the window still exists.
+        reply = propertyReply(c, ck.state);
+        props.valid = reply != 0;
+        if (reply && reply->format == 32)
+        {
+            const xcb_atom_t *atoms = static_cast<const xcb_atom_t *>(xcb_get_property_value(reply));
+            int count = xcb_get_property_value_length(reply) / sizeof(xcb_atom_t);
+            for (int j = 0; j < count; ++j)
+                for (int k = AtomFirstState; k <= AtomLastState; ++k)
+                    if (atoms[j] == mAtoms[k])
+                        props.state |= states[k - AtomFirstState];
+        }
+        free(reply);
+
+        reply = propertyReply(c, ck.transientFor);
+        if (reply && reply->format == 32 && xcb_get_property_value_length(reply) >= 4)
+            props.transientFor = *static_cast<const xcb_window_t *>(xcb_get_property_value(reply));
+        free(reply);
+
+        // The first known type wins, without any the window is
+        // a dialog when it's transient and a normal one otherwise.
+        props.windowType = props.transientFor ? NET::Dialog : NET::Normal;
+        reply = propertyReply(c, ck.type);
+        if (reply && reply->format == 32)
+        {
+            const xcb_atom_t *atoms = static_cast<const xcb_atom_t *>(xcb_get_property_value(reply));
+            int count = xcb_get_property_value_length(reply) / sizeof(xcb_atom_t);
+            bool found = false;
+            for (int j = 0; j < count && !found; ++j)
+                for (int k = AtomFirstType; k <= AtomLastType && !found; ++k)
+                    if (atoms[j] == mAtoms[k])
+                    {
+                        props.windowType = windowTypes[k - AtomFirstType];
+                        found = true;
+                    }
+            if (!found && count)
+                props.windowType = NET::Unknown;
+        }
+        free(reply);
+
+        reply = propertyReply(c, ck.desktop);
+        if (reply && reply->format == 32 && xcb_get_property_value_length(reply) >= 4)
+        {
+            quint32 desktop = *static_cast<const quint32 *>(xcb_get_property_value(reply));
+            props.desktop = desktop == 0xFFFFFFFF ? int(NET::OnAllDesktops) : int(desktop) + 1;
+        }
+        free(reply);
+
+        WId w = windows.at(i);
+        xcb_atom_t utf8 = mAtoms[AtomUTF8_STRING];
+        reply = propertyReply(c, ck.netName);
+        props.name = fullName(c, reply, w, mAtoms[Atom_NET_WM_NAME], utf8, utf8);
+        free(reply);
+
+        reply = propertyReply(c, ck.wmName);
+        if (props.name.isEmpty())
+            props.name = fullName(c, reply, w, XCB_ATOM_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY, utf8);
+        free(reply);
+
+        reply = propertyReply(c, ck.visibleName);
+        props.visibleName = fullName(c, reply, w, mAtoms[Atom_NET_WM_VISIBLE_NAME], utf8, utf8);
+        free(reply);
+
+        mWindows.insert(w, props);
+    }
+}
+
+
+/************************************************
+
+ ************************************************/
+void WindowPropertyStore::windowRemoved(WId window)
+{
+    WId leader = mWindows.value(window).transientFor;
+    mWindows.remove(window);
+    mUnmanaged.remove(window);
+    if (leader)
+        mUnmanaged.remove(leader);
+}
+
+
+/************************************************
+
+ ************************************************/
+void WindowPropertyStore::windowChanged(WId window, NET::Properties prop, NET::Properties2 prop2)
+{
+    mUnmanaged.remove(window);
+    QHash<WId, WindowProperties>::iterator it = mWindows.find(window);
+    if (it == mWindows.end())
+        return;
+
+    prop &= STORE_PROPERTIES;
+    prop2 &= STORE_PROPERTIES2;
+    // The default type depends on the transient-for hint.
+    if (prop & NET::WMWindowType)
+        prop2 |= NET::WM2TransientFor;
+    if (prop || prop2)
+        fetch(it.value(), window, prop, prop2);
+}
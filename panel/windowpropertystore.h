@@ -0,0 +1,80 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * http://lxqt.org
+ *
+ * Copyright: 2015 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+
+#ifndef WINDOWPROPERTYSTORE_H
+#define WINDOWPROPERTYSTORE_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include "windowproperties.h"
+
+/*! \brief The WindowPropertyStore class caches the properties of all the
+    managed windows for the plugins of all the panels.
+
+    The properties of a window are read from the X server once, when the
+    window appears, and after that only the properties named in the
+    KWindowSystem::windowChanged() masks are read again. The new windows
+    are read in batches, the requests for all of them are sent before the
+    first reply is awaited. The plugins get
+    them through ILxQtPanel::windowProperties() without a round trip.
+
+    The store is connected to KWindowSystem before any plugin is loaded, so
+    it's always up to date when the plugins get the same signals.
+ */
+class LXQT_PANEL_API WindowPropertyStore : public QObject
+{
+    Q_OBJECT
+public:
+    static WindowPropertyStore *instance();
+
+    WindowProperties properties(WId window) const;
+
+    int fetchCount() const { return mFetchCount; }
+    int hitCount() const { return mHitCount; }
+    int batchCount() const { return mBatchCount; }
+
+private slots:
+    void windowAdded(WId window);
+    void windowRemoved(WId window);
+    void windowChanged(WId window, NET::Properties prop, NET::Properties2 prop2);
+
+private:
+    WindowPropertyStore();
+
+    QHash<WId, WindowProperties> mWindows;
+    // The windows read by properties() that KWindowSystem doesn't manage.
+    mutable QHash<WId, WindowProperties> mUnmanaged;
+    mutable int mFetchCount;
+    mutable int mHitCount;
+    int mBatchCount;
+    QVector<quint32> mAtoms;
+
+    void fetchBatch(const QList<WId> &windows);
+    void fetch(WindowProperties &props, WId window, NET::Properties prop, NET::Properties2 prop2) const;
+};
+
+#endif // WINDOWPROPERTYSTORE_H
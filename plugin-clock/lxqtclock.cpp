@@ -38,7 +38,6 @@
 #include <QMouseEvent>
 
 #include <QDateTime>
-#include <QTimer>
 #include <QPoint>
 #include <QRect>
 
@@ -57,6 +56,7 @@
 LxQtClock::LxQtClock(const ILxQtPanelPluginStartupInfo &startupInfo):
     QObject(),
     ILxQtPanelPlugin(startupInfo),
+    mUpdateInterval(0),
     mAutoRotate(true)
 {
     mMainWidget = new QWidget();
@@ -90,9 +90,6 @@ LxQtClock::LxQtClock(const ILxQtPanelPluginStartupInfo &startupInfo):
     mMainWidget->setSizePolicy(QSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum));
 
 
-    mClockTimer = new QTimer(this);
-    connect (mClockTimer, SIGNAL(timeout()), SLOT(updateTime()));
-
     mClockFormat = "hh:mm";
 
     mCalendarPopup = new CalendarPopup(mContent);
@@ -120,12 +117,7 @@ QDateTime LxQtClock::currentDateTime()
  */
 void LxQtClock::updateTime()
 {
-    QDateTime now = currentDateTime();
-
-    if (now.time().msec() > 500)
-        restartTimer(now);
-
-    showTime(now);
+    showTime(currentDateTime());
 }
 
 void LxQtClock::showTime(const QDateTime &now)
@@ -145,16 +137,6 @@ void LxQtClock::showTime(const QDateTime &now)
     mRotatedWidget->update();
 }
 
-void LxQtClock::restartTimer(const QDateTime &now)
-{
-    if (mClockTimer->isActive())
-        mClockTimer->stop();
-    int updateInterval = mClockTimer->interval();
-    int delay = static_cast<int>((updateInterval + 100 /* ms after time change */ - ((now.time().msec() + now.time().second() * 1000) % updateInterval)) % updateInterval);
-    QTimer::singleShot(delay, this, SLOT(updateTime()));
-    QTimer::singleShot(delay, mClockTimer, SLOT(start()));
-}
-
 void LxQtClock::settingsChanged()
 {
     mTimeFormat = settings()->value("timeFormat", QLocale::system().timeFormat(QLocale::ShortFormat).toUpper().contains("AP") ? "h:mm AP" : "HH:mm").toString();
@@ -191,15 +173,15 @@ void LxQtClock::settingsChanged()
     // mDateFormat usually does not contain time portion, but since it's possible to use custom date format - it has to be supported. [Kuzma Shapran]
     int updateInterval = QString(mTimeFormat + " " + mDateFormat).replace(QRegExp("'[^']*'"),"").contains("s") ? 1000 : 60000;
 
-    QDateTime now = currentDateTime();
-
-    showTime(now);
+    showTime(currentDateTime());
 
-    if (mClockTimer->interval() != updateInterval)
+    // The ticks of the panel come on the second/minute boundaries.
+    if (mUpdateInterval != updateInterval)
     {
-        mClockTimer->setInterval(updateInterval);
+        mUpdateInterval = updateInterval;
 
-        restartTimer(now);
+        panel()->unsubscribeTick(this);
+        panel()->subscribeTick(mUpdateInterval, this, SLOT(updateTime()));
     }
 }
 
@@ -40,7 +40,6 @@
 
 class QLabel;
 class QDialog;
-class QTimer;
 
 class LxQtClock : public QObject, public ILxQtPanelPlugin
 {
@@ -67,7 +66,7 @@ protected:
     bool eventFilter(QObject *watched, QEvent *event);
 
 private:
-    QTimer* mClockTimer;
+    int mUpdateInterval;
     QWidget *mMainWidget;
     QWidget *mContent;
     LxQt::RotatedWidget* mRotatedWidget;
@@ -85,7 +84,6 @@ private:
 
     QDateTime currentDateTime();
     void showTime(const QDateTime &);
-    void restartTimer(const QDateTime&);
 
 private slots:
     void updateMinWidth();
@@ -95,7 +93,7 @@ private slots:
 class LxQtClockPluginLibrary: public QObject, public ILxQtPanelPluginLibrary
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA(IID "lxde-qt.org/Panel/PluginInterface/3.0")
+    Q_PLUGIN_METADATA(IID "lxde-qt.org/Panel/PluginInterface/3.1")
     Q_INTERFACES(ILxQtPanelPluginLibrary)
 public:
     ILxQtPanelPlugin *instance(const ILxQtPanelPluginStartupInfo &startupInfo) { return new LxQtClock(startupInfo);}
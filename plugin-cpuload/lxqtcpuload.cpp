@@ -52,7 +52,7 @@ LxQtCpuLoad::LxQtCpuLoad(ILxQtPanelPlugin* plugin, QWidget* parent):
     mPlugin(plugin),
 	m_showText(false),
     m_barOrientation(TopDownBar),
-    m_timerID(-1)
+    m_updateInterval(0)
 {
     setObjectName("LxQtCpuLoad");
 
@@ -110,7 +110,7 @@ double LxQtCpuLoad::getLoadCpu() const
 	return (cur->user + cur->kernel + cur->nice);
 }
 
-void LxQtCpuLoad::timerEvent(QTimerEvent *event)
+void LxQtCpuLoad::updateLoad()
 {
 	double avg = getLoadCpu();
 	if ( qAbs(m_avg-avg)>1 )
@@ -183,11 +183,15 @@ void LxQtCpuLoad::paintEvent ( QPaintEvent * )
 
 void LxQtCpuLoad::settingsChanged()
 {
-    if (m_timerID != -1)
-        killTimer(m_timerID);
-
     m_showText = mPlugin->settings()->value("showText", false).toBool();
-    m_updateInterval = mPlugin->settings()->value("updateInterval", 1000).toInt();
+
+    int updateInterval = mPlugin->settings()->value("updateInterval", 1000).toInt();
+    if (updateInterval != m_updateInterval)
+    {
+        m_updateInterval = updateInterval;
+        mPlugin->panel()->unsubscribeTick(this);
+        mPlugin->panel()->subscribeTick(m_updateInterval, this, SLOT(updateLoad()));
+    }
 
     QString barOrientation = mPlugin->settings()->value("barOrientation", BAR_ORIENT_BOTTOMUP).toString();
     if (barOrientation == BAR_ORIENT_RIGHTLEFT)
@@ -199,6 +203,5 @@ void LxQtCpuLoad::settingsChanged()
     else
         m_barOrientation = BottomUpBar;
 
-	m_timerID = startTimer(m_updateInterval);
 	update();
 }
@@ -58,10 +58,12 @@ public:
     QColor getFontColor() const { return fontColor; }
 
 protected:
-	void virtual timerEvent(QTimerEvent *event);
 	void virtual paintEvent ( QPaintEvent * event );
 	void virtual resizeEvent(QResizeEvent *);
 
+private slots:
+    void updateLoad();
+
 private:
 	double getLoadCpu() const;
 
@@ -74,7 +76,6 @@ private:
 	bool m_showText;
     BarOrientation m_barOrientation;
     int m_updateInterval;
-    int m_timerID;
 
 	QFont m_font;
     
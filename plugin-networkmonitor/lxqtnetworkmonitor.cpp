@@ -61,9 +61,9 @@ LxQtNetworkMonitor::LxQtNetworkMonitor(ILxQtPanelPlugin *plugin, QWidget* parent
     m_iconList << "modem" << "monitor"
                << "network" << "wireless";
 
-    startTimer(800);
-
     settingsChanged();
+
+    mPlugin->panel()->subscribeTick(ILxQtPanel::TickSecond, this, SLOT(updateStats()));
 }
 
 LxQtNetworkMonitor::~LxQtNetworkMonitor()
@@ -79,9 +79,9 @@ void LxQtNetworkMonitor::resizeEvent(QResizeEvent *)
 }
 
 
-void LxQtNetworkMonitor::timerEvent(QTimerEvent *event)
+void LxQtNetworkMonitor::updateStats()
 {
-    bool matched = false;
+    QString state = "error";
 
 #ifdef STATGRAB_NEWER_THAN_0_90
     size_t num_network_stats;
@@ -97,23 +97,13 @@ void LxQtNetworkMonitor::timerEvent(QTimerEvent *event)
         if (m_interface == QString::fromLocal8Bit(network_stats->interface_name))
         {
             if (network_stats->rx != 0 && network_stats->tx != 0)
-            {
-                m_pic.load(iconName("transmit-receive"));
-            }
+                state = "transmit-receive";
             else if (network_stats->rx != 0 && network_stats->tx == 0)
-            {
-                m_pic.load(iconName("receive"));
-            }
+                state = "receive";
             else if (network_stats->rx == 0 && network_stats->tx != 0)
-            {
-                m_pic.load(iconName("transmit"));
-            }
+                state = "transmit";
             else
-            {
-                m_pic.load(iconName("idle"));
-            }
-
-            matched = true;
+                state = "idle";
 
             break;
         }
@@ -121,11 +111,12 @@ void LxQtNetworkMonitor::timerEvent(QTimerEvent *event)
         network_stats++;
     }
 
-    if (!matched)
-    {
-        m_pic.load(iconName("error"));
-    }
+    // Most of the time nothing changes, don't load and paint the same icon.
+    if (state == m_state)
+        return;
 
+    m_state = state;
+    m_pic.load(iconName(m_state));
     update();
 }
 
@@ -200,7 +191,9 @@ void LxQtNetworkMonitor::settingsChanged()
             m_interface = QString(stats[0].interface_name);
     }
 
-    m_pic.load(iconName("error"));
+    m_state = "error";
+    m_pic.load(iconName(m_state));
+    update();
 }
 
 QString LxQtNetworkMonitor::convertUnits(double num)
@@ -43,11 +43,12 @@ public:
     virtual void settingsChanged();
 
 protected:
-    void virtual timerEvent(QTimerEvent *event);
     void virtual paintEvent(QPaintEvent * event);
     void virtual resizeEvent(QResizeEvent *);
     bool virtual event(QEvent *event);
 
+private slots:
+    void updateStats();
 
 private:
     static QString convertUnits(double num);
@@ -64,6 +65,7 @@ private:
     int m_iconIndex;
 
     QString m_interface;
+    QString m_state;
     QPixmap m_pic;
     ILxQtPanelPlugin *mPlugin;
 };
@@ -38,6 +38,7 @@
 LxQtSensors::LxQtSensors(ILxQtPanelPlugin *plugin, QWidget* parent):
     QFrame(parent),
     mPlugin(plugin),
+    mUpdateInterval(0),
     mSettings(plugin->settings())
 {
 
@@ -107,10 +108,9 @@ LxQtSensors::LxQtSensors(ILxQtPanelPlugin *plugin, QWidget* parent):
     // Updated sensors readings to display actual values at start
     updateSensorReadings();
 
-    // Run timer that will be updating sensor readings
-    mUpdateSensorReadingsTimer.setParent(this);
-    connect(&mUpdateSensorReadingsTimer, SIGNAL(timeout()), this, SLOT(updateSensorReadings()));
-    mUpdateSensorReadingsTimer.start(mSettings->value("updateInterval").toInt() * 1000);
+    // Sensor readings are updated on the ticks of the panel
+    mUpdateInterval = mSettings->value("updateInterval").toInt() * 1000;
+    mPlugin->panel()->subscribeTick(mUpdateInterval, this, SLOT(updateSensorReadings()));
 
     // Run timer that will be showin warning
     mWarningAboutHighTemperatureTimer.setParent(this);
@@ -261,7 +261,13 @@ void LxQtSensors::warningAboutHighTemperature()
 
 void LxQtSensors::settingsChanged()
 {
-    mUpdateSensorReadingsTimer.setInterval(mSettings->value("updateInterval").toInt() * 1000);
+    int updateInterval = mSettings->value("updateInterval").toInt() * 1000;
+    if (updateInterval != mUpdateInterval)
+    {
+        mUpdateInterval = updateInterval;
+        mPlugin->panel()->unsubscribeTick(this);
+        mPlugin->panel()->subscribeTick(mUpdateInterval, this, SLOT(updateSensorReadings()));
+    }
 
     // Iterator for temperature progress bars
     QList<ProgressBar*>::iterator temperatureProgressBarsIt =
@@ -65,7 +65,8 @@ public slots:
 private:
     ILxQtPanelPlugin *mPlugin;
     QBoxLayout *mLayout;
-    QTimer mUpdateSensorReadingsTimer;
+    // How often sensor readings are updated in ms
+    int mUpdateInterval;
     QTimer mWarningAboutHighTemperatureTimer;
     // How often warning time should fire in ms
     int mWarningAboutHighTemperatureTimerFreq;
@@ -87,6 +87,11 @@ void LxQtSysStat::realign()
     }
 }
 
+void LxQtSysStat::panelHiddenChanged(bool hidden)
+{
+    mContent->setPaused(hidden);
+}
+
 void LxQtSysStat::settingsChanged()
 {
     mContent->updateSettings(settings());
@@ -352,6 +357,18 @@ void LxQtSysStatContent::updateSettings(const QSettings *settings)
         update();
 }
 
+void LxQtSysStatContent::setPaused(bool paused)
+{
+    if (!mStat)
+        return;
+
+    // The first sample after the pause covers all the paused time.
+    if (paused)
+        mStat->stopUpdating();
+    else
+        mStat->setUpdateInterval(static_cast<int>(mUpdateInterval * 1000.0));
+}
+
 void LxQtSysStatContent::resizeEvent(QResizeEvent * /*event*/)
 {
     reset();
@@ -57,6 +57,7 @@ public:
     QDialog *configureDialog();
 
     void realign();
+    void panelHiddenChanged(bool hidden);
 
 protected slots:
     virtual void lateInit();
@@ -106,6 +107,7 @@ public:
     ~LxQtSysStatContent();
 
     void updateSettings(const QSettings *);
+    void setPaused(bool paused);
 
 #undef QSS_COLOUR
 #define QSS_COLOUR(GETNAME, SETNAME) \
@@ -214,7 +216,7 @@ private:
 class LxQtSysStatLibrary: public QObject, public ILxQtPanelPluginLibrary
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA(IID "lxde-qt.org/Panel/PluginInterface/3.0")
+    Q_PLUGIN_METADATA(IID "lxde-qt.org/Panel/PluginInterface/3.1")
     Q_INTERFACES(ILxQtPanelPluginLibrary)
 public:
     ILxQtPanelPlugin *instance(const ILxQtPanelPluginStartupInfo &startupInfo)
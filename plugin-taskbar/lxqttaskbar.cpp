@@ -56,6 +56,7 @@ using namespace LxQt;
 LxQtTaskBar::LxQtTaskBar(ILxQtPanelPlugin *plugin, QWidget *parent) :
     QFrame(parent),
     mButtonStyle(Qt::ToolButtonTextBesideIcon),
+    mIconSize(0),
     mCheckedBtn(NULL),
     mCloseOnMiddleClick(true),
     mShowOnlyCurrentDesktopTasks(false),
@@ -75,11 +76,21 @@ LxQtTaskBar::LxQtTaskBar(ILxQtPanelPlugin *plugin, QWidget *parent) :
     mPlaceHolder->setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding));
     mLayout->addWidget(mPlaceHolder);
 
+    // Coalesces the icon geometry updates of a burst of changes (added or
+    // removed buttons, realign, resize); it fires once the layout has placed
+    // the buttons.
+    mIconGeometryTimer.setSingleShot(true);
+    mIconGeometryTimer.setInterval(0);
+    connect(&mIconGeometryTimer, SIGNAL(timeout()), SLOT(refreshIconGeometry()));
+
     settingsChanged();
     setAcceptDrops(true);
 
-    connect(KWindowSystem::self(), SIGNAL(stackingOrderChanged()), SLOT(refreshTaskList()));
-    connect(KWindowSystem::self(), SIGNAL(currentDesktopChanged(int)), SLOT(refreshTaskList()));
+    refreshTaskList();
+
+    connect(KWindowSystem::self(), SIGNAL(windowAdded(WId)), SLOT(onWindowAdded(WId)));
+    connect(KWindowSystem::self(), SIGNAL(windowRemoved(WId)), SLOT(onWindowRemoved(WId)));
+    connect(KWindowSystem::self(), SIGNAL(currentDesktopChanged(int)), SLOT(refreshButtonVisibility()));
     connect(KWindowSystem::self(), SIGNAL(activeWindowChanged(WId)), SLOT(activeWindowChanged(WId)));
     connect(KWindowSystem::self(), SIGNAL(windowChanged(WId, NET::Properties, NET::Properties2)),
             SLOT(windowChanged(WId, NET::Properties, NET::Properties2)));
@@ -111,11 +122,7 @@ bool LxQtTaskBar::windowOnActiveDesktop(WId window) const
     if (!mShowOnlyCurrentDesktopTasks)
         return true;
 
-    int desktop = KWindowInfo(window, NET::WMDesktop).desktop();
-    if (desktop == NET::OnAllDesktops)
-        return true;
-
-    return desktop == KWindowSystem::currentDesktop();
+    return mPlugin->panel()->windowProperties(window).isOnDesktop(KWindowSystem::currentDesktop());
 }
 
 /************************************************
@@ -132,29 +139,29 @@ bool LxQtTaskBar::acceptWindow(WId window) const
     ignoreList |= NET::PopupMenuMask;
     ignoreList |= NET::NotificationMask;
 
-    KWindowInfo info(window, NET::WMWindowType | NET::WMState, NET::WM2TransientFor);
-    if (!info.valid())
+    WindowProperties props = mPlugin->panel()->windowProperties(window);
+    if (!props.valid)
         return false;
 
-    if (NET::typeMatchesMask(info.windowType(NET::AllTypesMask), ignoreList))
+    if (NET::typeMatchesMask(props.windowType, ignoreList))
         return false;
 
-    if (info.state() & NET::SkipTaskbar)
+    if (props.hasState(NET::SkipTaskbar))
         return false;
 
     // WM_TRANSIENT_FOR hint not set - normal window
-    WId transFor = info.transientFor();
+    WId transFor = props.transientFor;
     if (transFor == 0 || transFor == window || transFor == (WId) QX11Info::appRootWindow())
         return true;
 
-    info = KWindowInfo(transFor, NET::WMWindowType);
+    props = mPlugin->panel()->windowProperties(transFor);
 
     QFlags<NET::WindowTypeMask> normalFlag;
     normalFlag |= NET::NormalMask;
     normalFlag |= NET::DialogMask;
     normalFlag |= NET::UtilityMask;
 
-    return !NET::typeMatchesMask(info.windowType(NET::AllTypesMask), normalFlag);
+    return !NET::typeMatchesMask(props.windowType, normalFlag);
 }
 
 /************************************************
@@ -211,40 +218,76 @@ void LxQtTaskBar::dropEvent(QDropEvent* event)
  ************************************************/
 void LxQtTaskBar::refreshTaskList()
 {
-    QList<WId> tmp = KWindowSystem::stackingOrder();
+    // Only used to populate the taskbar on startup, after that the
+    // buttons follow the windowAdded()/windowRemoved() deltas.
+    foreach (WId wnd, KWindowSystem::stackingOrder())
+        addWindow(wnd);
 
-    QMutableHashIterator<WId, LxQtTaskButton*> i(mButtonsHash);
-    while (i.hasNext())
-    {
-        i.next();
-        int n = tmp.removeAll(i.key());
+    refreshPlaceHolderVisibility();
+    activeWindowChanged();
+}
 
-        if (!n)
-        {
-            // if the button we're removing is the currently selected app
-            if(i.value() == mCheckedBtn)
-                mCheckedBtn = NULL;
-            delete i.value();
-            i.remove();
-        }
-    }
+/************************************************
 
-    foreach (WId wnd, tmp)
-    {
-        if (acceptWindow(wnd))
-        {
-            LxQtTaskButton* btn = new LxQtTaskButton(wnd, this);
-            btn->setStyle(mStyle);
-            btn->setToolButtonStyle(mButtonStyle);
+ ************************************************/
+LxQtTaskButton* LxQtTaskBar::addWindow(WId window)
+{
+    if (mButtonsHash.contains(window) || !acceptWindow(window))
+        return 0;
+
+    LxQtTaskButton* btn = new LxQtTaskButton(window, mPlugin->panel(), this);
+    btn->setStyle(mStyle);
+    btn->setToolButtonStyle(mButtonStyle);
+    btn->setAutoRotation(mAutoRotate && (mButtonStyle != Qt::ToolButtonIconOnly),
+                         mPlugin->panel()->position());
+    btn->setVisible(windowOnActiveDesktop(window));
+
+    mButtonsHash.insert(window, btn);
+    mLayout->addWidget(btn);
+    return btn;
+}
 
-            mButtonsHash.insert(wnd, btn);
-            mLayout->addWidget(btn);
-        }
-    }
-    refreshButtonVisibility();
-    mLayout->invalidate();
-    activeWindowChanged();
-    realign();
+/************************************************
+
+ ************************************************/
+bool LxQtTaskBar::removeWindow(WId window)
+{
+    LxQtTaskButton* btn = mButtonsHash.take(window);
+    if (!btn)
+        return false;
+
+    // if the button we're removing is the currently selected app
+    if (btn == mCheckedBtn)
+        mCheckedBtn = NULL;
+    mIconGeometry.remove(window);
+    delete btn;
+    return true;
+}
+
+/************************************************
+
+ ************************************************/
+void LxQtTaskBar::onWindowAdded(WId window)
+{
+    if (!addWindow(window))
+        return;
+
+    refreshPlaceHolderVisibility();
+    if (window == KWindowSystem::activeWindow())
+        activeWindowChanged(window);
+    mIconGeometryTimer.start();
+}
+
+/************************************************
+
+ ************************************************/
+void LxQtTaskBar::onWindowRemoved(WId window)
+{
+    if (!removeWindow(window))
+        return;
+
+    refreshPlaceHolderVisibility();
+    mIconGeometryTimer.start();
 }
 
 /************************************************
@@ -269,15 +312,29 @@ void LxQtTaskBar::refreshButtonRotation()
 
 void LxQtTaskBar::refreshButtonVisibility()
 {
-    bool haveVisibleWindow = false;
     QHashIterator<WId, LxQtTaskButton*> i(mButtonsHash);
     while (i.hasNext())
     {
         i.next();
-        bool isVisible = windowOnActiveDesktop(i.key());
-        haveVisibleWindow |= isVisible;
-        i.value()->setVisible(isVisible);
+        i.value()->setVisible(windowOnActiveDesktop(i.key()));
     }
+    refreshPlaceHolderVisibility();
+    mIconGeometryTimer.start();
+}
+
+/************************************************
+
+ ************************************************/
+void LxQtTaskBar::refreshPlaceHolderVisibility()
+{
+    bool haveVisibleWindow = false;
+    QHashIterator<WId, LxQtTaskButton*> i(mButtonsHash);
+    while (i.hasNext() && !haveVisibleWindow)
+    {
+        i.next();
+        haveVisibleWindow = !i.value()->isHidden();
+    }
+
     mPlaceHolder->setVisible(!haveVisibleWindow);
     if (haveVisibleWindow)
         mPlaceHolder->setFixedSize(0, 0);
@@ -286,7 +343,6 @@ void LxQtTaskBar::refreshButtonVisibility()
         mPlaceHolder->setMinimumSize(1, 1);
         mPlaceHolder->setMaximumSize(QWIDGETSIZE_MAX, QWIDGETSIZE_MAX);
     }
-
 }
 
 /************************************************
@@ -297,17 +353,33 @@ void LxQtTaskBar::refreshIconGeometry()
     // FIXME: sometimes we get wrong globalPos here, especially
     // after changing the pos or size of the panel.
     // this might be caused by bugs in lxqtpanel.cpp.
+    //
+    // Only the rectangles that changed since the last time are written.
+    // NETWinInfo is created without any properties, so it doesn't read
+    // anything, and the writes go to the X server together with the next
+    // flush of the connection.
     QHashIterator<WId, LxQtTaskButton*> i(mButtonsHash);
     while (i.hasNext())
     {
         i.next();
         LxQtTaskButton* button = i.value();
+        if (button->isHidden())
+        {
+            mIconGeometry.remove(i.key());
+            continue;
+        }
+
         QRect rect = button->geometry();
         QPoint globalPos = mapToGlobal(button->pos());
         rect.moveTo(globalPos);
 
+        QHash<WId, QRect>::iterator it = mIconGeometry.find(i.key());
+        if (it != mIconGeometry.end() && it.value() == rect)
+            continue;
+        mIconGeometry.insert(i.key(), rect);
+
         NETWinInfo info(QX11Info::connection(), button->windowId(),
-                        (WId) QX11Info::appRootWindow(), NET::WMIconGeometry, 0);
+                        (WId) QX11Info::appRootWindow(), 0, 0);
         NETRect nrect;
         nrect.pos.x = rect.x();
         nrect.pos.y = rect.y();
@@ -346,6 +418,22 @@ void LxQtTaskBar::activeWindowChanged(WId window)
  ************************************************/
 void LxQtTaskBar::windowChanged(WId window, NET::Properties prop, NET::Properties2 prop2)
 {
+    // Our own writes in refreshIconGeometry() come back here, nothing
+    // on the button depends on the icon geometry.
+    if (prop == NET::WMIconGeometry && prop2 == 0)
+        return;
+
+    // the window type, the skip taskbar state or the transient-for hint
+    // decide whether the window gets a button at all
+    if (prop.testFlag(NET::WMWindowType) || prop.testFlag(NET::WMState) || prop2.testFlag(NET::WM2TransientFor))
+    {
+        bool accepted = acceptWindow(window);
+        if (accepted && !mButtonsHash.contains(window))
+            onWindowAdded(window);
+        else if (!accepted && mButtonsHash.contains(window))
+            onWindowRemoved(window);
+    }
+
     LxQtTaskButton* button = buttonByWindow(window);
     if (!button)
         return;
@@ -357,18 +445,20 @@ void LxQtTaskBar::windowChanged(WId window, NET::Properties prop, NET::Propertie
         {
             int desktop = button->desktopNum();
             button->setHidden(desktop != NET::OnAllDesktops && desktop != KWindowSystem::currentDesktop());
+            refreshPlaceHolderVisibility();
+            // the button and its neighbours moved
+            mIconGeometryTimer.start();
         }
     }
 
     if (prop.testFlag(NET::WMVisibleName) || prop.testFlag(NET::WMName))
         button->updateText();
 
-    // FIXME: NET::WMIconGeometry is causing high CPU and memory usage
-    if (prop.testFlag(NET::WMIcon) /*|| prop.testFlag(NET::WMIconGeometry)*/)
+    if (prop.testFlag(NET::WMIcon))
         button->updateIcon();
 
     if (prop.testFlag(NET::WMState))
-        button->setUrgencyHint(KWindowInfo(window, NET::WMState).hasState(NET::DemandsAttention));
+        button->setUrgencyHint(mPlugin->panel()->windowProperties(window).hasState(NET::DemandsAttention));
 }
 
 /************************************************
@@ -405,7 +495,8 @@ void LxQtTaskBar::settingsChanged()
     mAutoRotate = mPlugin->settings()->value("autoRotate", true).toBool();
     mCloseOnMiddleClick = mPlugin->settings()->value("closeOnMiddleClick", true).toBool();
 
-    refreshTaskList();
+    refreshButtonVisibility();
+    realign();
 }
 
 /************************************************
@@ -418,6 +509,18 @@ void LxQtTaskBar::realign()
     refreshButtonRotation();
 
     ILxQtPanel *panel = mPlugin->panel();
+
+    // The cached icons are fetched for the icon size of the panel.
+    if (mIconSize != panel->iconSize())
+    {
+        mIconSize = panel->iconSize();
+        QHashIterator<WId, LxQtTaskButton*> i(mButtonsHash);
+        while (i.hasNext())
+        {
+            i.next();
+            i.value()->updateIcon();
+        }
+    }
     QSize maxSize = QSize(QWIDGETSIZE_MAX, QWIDGETSIZE_MAX);
     QSize minSize = QSize(0, 0);
 
@@ -515,7 +618,7 @@ void LxQtTaskBar::realign()
 
     mLayout->setDirection(rotated ? LxQt::GridLayout::TopToBottom : LxQt::GridLayout::LeftToRight);
     mLayout->setEnabled(true);
-    refreshIconGeometry();
+    mIconGeometryTimer.start();
 }
 
 /************************************************
@@ -533,8 +636,7 @@ void LxQtTaskBar::mousePressEvent(QMouseEvent *event)
         {
             i.next();
             LxQtTaskButton* btn = i.value();
-            if (btn->geometry().contains(event->pos()) &&
-                (!mShowOnlyCurrentDesktopTasks || KWindowSystem::currentDesktop() == KWindowInfo(i.key(), NET::WMDesktop).desktop()))
+            if (btn->geometry().contains(event->pos()) && windowOnActiveDesktop(i.key()))
             {
                 btn->closeApplication();
                 break;
@@ -577,7 +679,7 @@ void LxQtTaskBar::wheelEvent(QWheelEvent* event)
  ************************************************/
 void LxQtTaskBar::resizeEvent(QResizeEvent* event)
 {
-    refreshIconGeometry();
+    mIconGeometryTimer.start();
     return QWidget::resizeEvent(event);
 }
 
@@ -37,6 +37,7 @@
 #include <QFrame>
 #include <QBoxLayout>
 #include <QHash>
+#include <QTimer>
 #include "../panel/ilxqtpanel.h"
 #include <KF5/KWindowSystem/KWindowSystem>
 #include <KF5/KWindowSystem/KWindowInfo>
@@ -71,7 +72,8 @@ protected:
     virtual void dropEvent(QDropEvent * event);
 
 private slots:
-    void refreshTaskList();
+    void onWindowAdded(WId window);
+    void onWindowRemoved(WId window);
     void refreshButtonRotation();
     void refreshButtonVisibility();
 
@@ -80,11 +82,18 @@ private:
     LxQt::GridLayout *mLayout;
     Qt::ToolButtonStyle mButtonStyle;
     int mButtonWidth;
+    int mIconSize;
     LxQtTaskButton* mCheckedBtn;
     bool mCloseOnMiddleClick;
     bool mShowOnlyCurrentDesktopTasks;
     bool mAutoRotate;
+    QTimer mIconGeometryTimer;
+    QHash<WId, QRect> mIconGeometry;
 
+    void refreshTaskList();
+    LxQtTaskButton* addWindow(WId window);
+    bool removeWindow(WId window);
+    void refreshPlaceHolderVisibility();
     LxQtTaskButton* buttonByWindow(WId window) const;
     bool windowOnActiveDesktop(WId window) const;
     bool acceptWindow(WId window) const;
@@ -66,9 +66,10 @@ void ElidedButtonStyle::drawItemText(QPainter* painter, const QRect& rect,
 /************************************************
 
 ************************************************/
-LxQtTaskButton::LxQtTaskButton(const WId window, QWidget *parent) :
+LxQtTaskButton::LxQtTaskButton(const WId window, ILxQtPanel *panel, QWidget *parent) :
     QToolButton(parent),
     mWindow(window),
+    mPanel(panel),
     mDrawPixmap(false)
 {
     setCheckable(true);
@@ -95,8 +96,7 @@ LxQtTaskButton::~LxQtTaskButton()
  ************************************************/
 void LxQtTaskButton::updateText()
 {
-    KWindowInfo info(mWindow, NET::WMVisibleName | NET::WMName);
-    QString title = info.visibleName().isEmpty() ? info.name() : info.visibleName();
+    QString title = mPanel->windowProperties(mWindow).title();
     setText(title.replace("&", "&&"));
     setToolTip(title);
 }
@@ -106,11 +106,9 @@ void LxQtTaskButton::updateText()
  ************************************************/
 void LxQtTaskButton::updateIcon()
 {
-    QIcon ico;
-    QPixmap pix = KWindowSystem::icon(mWindow);
-    ico.addPixmap(pix);
+    QPixmap pix = mPanel->windowIcon(mWindow, mPanel->iconSize());
     if (!pix.isNull())
-        setIcon(ico);
+        setIcon(QIcon(pix));
     else
         setIcon(XdgIcon::defaultApplicationIcon());
 }
@@ -197,8 +195,7 @@ void LxQtTaskButton::mouseMoveEvent(QMouseEvent* event)
  ************************************************/
 bool LxQtTaskButton::isAppHidden() const
 {
-    KWindowInfo info(mWindow, NET::WMState);
-    return (info.state() & NET::Hidden);
+    return mPanel->windowProperties(mWindow).hasState(NET::Hidden);
 }
 
 /************************************************
@@ -227,8 +224,7 @@ void LxQtTaskButton::activateWithDraggable()
  ************************************************/
 void LxQtTaskButton::raiseApplication()
 {
-    KWindowInfo info(mWindow, NET::WMDesktop);
-    int winDesktop = info.desktop();
+    int winDesktop = mPanel->windowProperties(mWindow).desktop;
     if (KWindowSystem::currentDesktop() != winDesktop)
         KWindowSystem::setCurrentDesktop(winDesktop);
     KWindowSystem::activateWindow(mWindow);
@@ -362,7 +358,8 @@ void LxQtTaskButton::contextMenuEvent(QContextMenuEvent* event)
     }
 
     KWindowInfo info(mWindow, 0, NET::WM2AllowedActions);
-    unsigned long state = KWindowInfo(mWindow, NET::WMState).state();
+    WindowProperties props = mPanel->windowProperties(mWindow);
+    unsigned long state = props.state;
 
     QMenu menu(tr("Application"));
     QAction* a;
@@ -396,7 +393,7 @@ void LxQtTaskButton::contextMenuEvent(QContextMenuEvent* event)
     int deskNum = KWindowSystem::numberOfDesktops();
     if (deskNum > 1)
     {
-        int winDesk = KWindowInfo(mWindow, NET::WMDesktop).desktop();
+        int winDesk = props.desktop;
         QMenu* deskMenu = menu.addMenu(tr("To &Desktop"));
 
         a = deskMenu->addAction(tr("&All Desktops"));
@@ -515,7 +512,7 @@ void LxQtTaskButton::setUrgencyHint(bool set)
  ************************************************/
 int LxQtTaskButton::desktopNum() const
 {
-    return KWindowInfo(mWindow, NET::WMDesktop).desktop();
+    return mPanel->windowProperties(mWindow).desktop;
 }
 
 Qt::Corner LxQtTaskButton::origin() const
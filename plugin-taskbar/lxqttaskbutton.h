@@ -58,7 +58,7 @@ class LxQtTaskButton : public QToolButton
     Q_PROPERTY(Qt::Corner origin READ origin WRITE setOrigin)
 
 public:
-    explicit LxQtTaskButton(const WId window, QWidget *parent = 0);
+    explicit LxQtTaskButton(const WId window, ILxQtPanel *panel, QWidget *parent = 0);
     virtual ~LxQtTaskButton();
 
     bool isAppHidden() const;
@@ -99,6 +99,7 @@ protected:
 
 private:
     WId mWindow;
+    ILxQtPanel *mPanel;
     bool mUrgencyHint;
     const QMimeData *mDraggableMimeData;
     QPoint mDragStartPosition;
@@ -36,7 +36,6 @@
 #include <QHBoxLayout>
 #include <QLocale>
 #include <QScopedArrayPointer>
-#include <QTimer>
 #include <QWheelEvent>
 
 
@@ -44,7 +43,6 @@ LxQtWorldClock::LxQtWorldClock(const ILxQtPanelPluginStartupInfo &startupInfo):
     QObject(),
     ILxQtPanelPlugin(startupInfo),
     mPopup(NULL),
-    mTimer(new QTimer(this)),
     mAutoRotate(true),
     mPopupContent(NULL)
 {
@@ -65,8 +63,6 @@ LxQtWorldClock::LxQtWorldClock(const ILxQtPanelPluginStartupInfo &startupInfo):
 
     settingsChanged();
 
-    connect(mTimer, SIGNAL(timeout()), SLOT(timeout()));
-
     connect(mContent, SIGNAL(wheelScrolled(int)), SLOT(wheelScrolled(int)));
 }
 
@@ -93,17 +89,9 @@ void LxQtWorldClock::timeout()
 
 void LxQtWorldClock::restartTimer(int timerInterval)
 {
-    mTimer->stop();
-    mTimer->setInterval(timerInterval);
-
-    if (timerInterval < 1000)
-        mTimer->start();
-    else
-    {
-        int delay = static_cast<int>((timerInterval + 100 - (static_cast<long long>(QTime::currentTime().msecsSinceStartOfDay()) % timerInterval)) % timerInterval);
-        QTimer::singleShot(delay, this, SLOT(timeout()));
-        QTimer::singleShot(delay, mTimer, SLOT(start()));
-    }
+    // The ticks of the panel come on the interval boundaries.
+    panel()->unsubscribeTick(this);
+    panel()->subscribeTick(timerInterval, this, SLOT(timeout()));
 }
 
 void LxQtWorldClock::settingsChanged()
@@ -41,7 +41,6 @@
 
 
 class ActiveLabel;
-class QTimer;
 class LxQtWorldClockPopup;
 
 
@@ -73,8 +72,6 @@ private:
     ActiveLabel *mContent;
     LxQtWorldClockPopup* mPopup;
 
-    QTimer *mTimer;
-
     QStringList mTimeZones;
     QMap<QString, QString> mTimeZoneCustomNames;
     QString mDefaultTimeZone;
@@ -131,7 +128,7 @@ protected:
 class LxQtWorldClockLibrary: public QObject, public ILxQtPanelPluginLibrary
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA(IID "lxde-qt.org/Panel/PluginInterface/3.0")
+    Q_PLUGIN_METADATA(IID "lxde-qt.org/Panel/PluginInterface/3.1")
     Q_INTERFACES(ILxQtPanelPluginLibrary)
 public:
     ILxQtPanelPlugin *instance(const ILxQtPanelPluginStartupInfo &startupInfo)